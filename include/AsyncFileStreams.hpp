@@ -0,0 +1,924 @@
+#pragma once
+#include <atomic>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <format>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <algorithm>
+#include <stdexcept>
+#include <string_view>
+#include <condition_variable>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+
+#if defined(__linux__) && __has_include(<linux/io_uring.h>)
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <linux/io_uring.h>
+#endif
+
+#include "IOStreams.hpp"
+#include "FdStreams.hpp"
+
+
+namespace io {
+    enum class AsyncBackend {
+        Auto        = 0,    // io_uring when the kernel allows it, the thread pool otherwise
+        IoUring     = 1,
+        ThreadPool  = 2
+    };
+
+    namespace __impl {
+        class AsyncQueue {
+        public:
+            virtual ~AsyncQueue() = default;
+
+            virtual bool
+            Submit(size_t uSlot, bool bWrite, int fd, std::byte* lpData, size_t uSize, uint64_t uOffset) = 0;
+
+            virtual ssize_t
+            Wait(size_t uSlot) = 0;
+        };
+
+#if defined(__linux__) && __has_include(<linux/io_uring.h>)
+        class IoUringQueue final :
+            public AsyncQueue {
+        public:
+            IoUringQueue(size_t uDepth) :
+                vecIov(uDepth),
+                vecResults(uDepth)
+            {
+                io_uring_params
+                    params  = {};
+                this->fd    = (int)syscall(__NR_io_uring_setup, (unsigned)uDepth, &params);
+                if (this->fd < 0) {
+                    throw std::runtime_error(std::format(
+                        "io_uring_setup failed: {}",
+                        strerror(errno)));
+                }
+
+                this->uSqSize   = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+                this->uCqSize   = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+                if (params.features & IORING_FEAT_SINGLE_MMAP) {
+                    this->uSqSize   = std::max(this->uSqSize, this->uCqSize);
+                    this->uCqSize   = 0;
+                }
+                this->uSqesSize = params.sq_entries * sizeof(io_uring_sqe);
+
+                this->lpSq      = this->Map(this->uSqSize, IORING_OFF_SQ_RING);
+                this->lpCq      = (this->uCqSize != 0)
+                    ? this->Map(this->uCqSize, IORING_OFF_CQ_RING)
+                    : this->lpSq;
+                this->lpSqes    = (io_uring_sqe*)this->Map(this->uSqesSize, IORING_OFF_SQES);
+                if (this->lpSq == nullptr || this->lpCq == nullptr || this->lpSqes == nullptr) {
+                    int iError  = errno;
+                    this->Unmap();
+                    throw std::runtime_error(std::format(
+                        "failed to map io_uring: {}",
+                        strerror(iError)));
+                }
+
+                this->lpSqTail  = (unsigned*)(this->lpSq + params.sq_off.tail);
+                this->uSqMask   = *(unsigned*)(this->lpSq + params.sq_off.ring_mask);
+                this->lpSqArray = (unsigned*)(this->lpSq + params.sq_off.array);
+                this->lpCqHead  = (unsigned*)(this->lpCq + params.cq_off.head);
+                this->lpCqTail  = (unsigned*)(this->lpCq + params.cq_off.tail);
+                this->uCqMask   = *(unsigned*)(this->lpCq + params.cq_off.ring_mask);
+                this->lpCqes    = (io_uring_cqe*)(this->lpCq + params.cq_off.cqes);
+            }
+
+            IoUringQueue(const IoUringQueue&) = delete;
+            IoUringQueue&
+            operator=(const IoUringQueue&) = delete;
+
+            ~IoUringQueue() noexcept {
+                this->Unmap();
+            }
+
+            bool
+            Submit(size_t uSlot, bool bWrite, int fdFile, std::byte* lpData, size_t uSize, uint64_t uOffset) override {
+                this->vecIov[uSlot]     = { lpData, uSize };
+                this->vecResults[uSlot] = { false, 0 };
+
+                unsigned
+                    uTail   = *this->lpSqTail,
+                    uIndex  = uTail & this->uSqMask;
+                io_uring_sqe&
+                    sqe     = this->lpSqes[uIndex];
+                memset(&sqe, 0, sizeof(sqe));
+                sqe.opcode      = bWrite ? IORING_OP_WRITEV : IORING_OP_READV;
+                sqe.fd          = fdFile;
+                sqe.addr        = (uint64_t)(uintptr_t)&this->vecIov[uSlot];
+                sqe.len         = 1;
+                sqe.off         = uOffset;
+                sqe.user_data   = uSlot;
+                this->lpSqArray[uIndex] = uIndex;
+                std::atomic_ref<unsigned>(*this->lpSqTail).store(uTail + 1, std::memory_order_release);
+
+                for (;;) {
+                    long iResult    = syscall(__NR_io_uring_enter, this->fd, 1, 0, 0, nullptr, 0);
+                    if (iResult < 0 && (errno == EINTR || errno == EAGAIN || errno == EBUSY))
+                        continue;
+                    return iResult == 1;
+                }
+            }
+
+            ssize_t
+            Wait(size_t uSlot) override {
+                for (;;) {
+                    this->Reap();
+                    if (this->vecResults[uSlot].bDone)
+                        return this->vecResults[uSlot].iResult;
+
+                    long iResult    = syscall(__NR_io_uring_enter, this->fd, 0, 1, IORING_ENTER_GETEVENTS, nullptr, 0);
+                    if (iResult < 0 && errno != EINTR)
+                        return -errno;
+                }
+            }
+
+        private:
+            struct Completion {
+                bool
+                    bDone   = false;
+                ssize_t
+                    iResult = 0;
+            };
+
+            std::byte*
+            Map(size_t uSize, off_t offset) noexcept {
+                void* lpMapping =
+                    mmap(nullptr, uSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, this->fd, offset);
+                return (lpMapping != MAP_FAILED) ? (std::byte*)lpMapping : nullptr;
+            }
+
+            void
+            Unmap() noexcept {
+                if (this->lpSqes != nullptr)
+                    munmap(this->lpSqes, this->uSqesSize);
+                if (this->lpCq != nullptr && this->lpCq != this->lpSq)
+                    munmap(this->lpCq, this->uCqSize);
+                if (this->lpSq != nullptr)
+                    munmap(this->lpSq, this->uSqSize);
+                close(this->fd);
+            }
+
+            void
+            Reap() noexcept {
+                unsigned
+                    uHead   = *this->lpCqHead,
+                    uTail   = std::atomic_ref<unsigned>(*this->lpCqTail).load(std::memory_order_acquire);
+                for (; uHead != uTail; ++uHead) {
+                    const io_uring_cqe&
+                        cqe = this->lpCqes[uHead & this->uCqMask];
+                    this->vecResults[(size_t)cqe.user_data] = { true, cqe.res };
+                }
+                std::atomic_ref<unsigned>(*this->lpCqHead).store(uHead, std::memory_order_release);
+            }
+
+            int
+                fd          = -1;
+            std::byte
+                *lpSq       = nullptr,
+                *lpCq       = nullptr;
+            io_uring_sqe*
+                lpSqes      = nullptr;
+            io_uring_cqe*
+                lpCqes      = nullptr;
+            unsigned
+                *lpSqTail   = nullptr,
+                *lpSqArray  = nullptr,
+                *lpCqHead   = nullptr,
+                *lpCqTail   = nullptr,
+                uSqMask     = 0,
+                uCqMask     = 0;
+            size_t
+                uSqSize     = 0,
+                uCqSize     = 0,
+                uSqesSize   = 0;
+            std::vector<iovec>
+                vecIov;
+            std::vector<Completion>
+                vecResults;
+        };
+#endif
+
+        class ThreadPoolQueue final :
+            public AsyncQueue {
+        public:
+            static constexpr size_t
+                uMaxThreads = 8;
+
+            ThreadPoolQueue(size_t uDepth) :
+                vecResults(uDepth)
+            {
+                for (size_t i = 0; i < std::min(uDepth, uMaxThreads); ++i)
+                    this->vecThreads.emplace_back([this] { this->Worker(); });
+            }
+
+            ThreadPoolQueue(const ThreadPoolQueue&) = delete;
+            ThreadPoolQueue&
+            operator=(const ThreadPoolQueue&) = delete;
+
+            ~ThreadPoolQueue() noexcept {
+                {
+                    std::lock_guard
+                        lock(this->mtx);
+                    this->bStop = true;
+                }
+                this->cvJobs.notify_all();
+                for (auto& thread : this->vecThreads)
+                    thread.join();
+            }
+
+            bool
+            Submit(size_t uSlot, bool bWrite, int fdFile, std::byte* lpData, size_t uSize, uint64_t uOffset) override {
+                {
+                    std::lock_guard
+                        lock(this->mtx);
+                    this->vecResults[uSlot] = { false, 0 };
+                    this->deqJobs.push_back({ uSlot, bWrite, fdFile, lpData, uSize, uOffset });
+                }
+                this->cvJobs.notify_one();
+                return true;
+            }
+
+            ssize_t
+            Wait(size_t uSlot) override {
+                std::unique_lock
+                    lock(this->mtx);
+                this->cvDone.wait(lock, [&] { return this->vecResults[uSlot].bDone; });
+                return this->vecResults[uSlot].iResult;
+            }
+
+        private:
+            struct Job {
+                size_t
+                    uSlot;
+                bool
+                    bWrite;
+                int
+                    fd;
+                std::byte*
+                    lpData;
+                size_t
+                    uSize;
+                uint64_t
+                    uOffset;
+            };
+
+            struct Completion {
+                bool
+                    bDone   = false;
+                ssize_t
+                    iResult = 0;
+            };
+
+            static ssize_t
+            Execute(const Job& job) noexcept {
+                size_t
+                    uDone   = 0;
+                while (uDone != job.uSize) {
+                    ssize_t
+                        iResult = job.bWrite
+                            ? pwrite(job.fd, job.lpData + uDone, job.uSize - uDone, (off_t)(job.uOffset + uDone))
+                            : pread(job.fd, job.lpData + uDone, job.uSize - uDone, (off_t)(job.uOffset + uDone));
+                    if (iResult < 0 && errno == EINTR)
+                        continue;
+                    if (iResult < 0)
+                        return (uDone != 0) ? (ssize_t)uDone : -errno;
+                    if (iResult == 0)
+                        break;
+                    uDone   += (size_t)iResult;
+                }
+
+                return (ssize_t)uDone;
+            }
+
+            void
+            Worker() noexcept {
+                std::unique_lock
+                    lock(this->mtx);
+                for (;;) {
+                    this->cvJobs.wait(lock, [&] { return this->bStop || !this->deqJobs.empty(); });
+                    if (this->deqJobs.empty())
+                        return;
+
+                    Job
+                        job = this->deqJobs.front();
+                    this->deqJobs.pop_front();
+
+                    lock.unlock();
+                    ssize_t
+                        iResult = Execute(job);
+                    lock.lock();
+
+                    this->vecResults[job.uSlot] = { true, iResult };
+                    this->cvDone.notify_all();
+                }
+            }
+
+            std::mutex
+                mtx;
+            std::condition_variable
+                cvJobs,
+                cvDone;
+            std::deque<Job>
+                deqJobs;
+            std::vector<Completion>
+                vecResults;
+            std::vector<std::thread>
+                vecThreads;
+            bool
+                bStop   = false;
+        };
+
+        inline std::unique_ptr<AsyncQueue>
+        MakeAsyncQueue(AsyncBackend backend, size_t uDepth) {
+#if defined(__linux__) && __has_include(<linux/io_uring.h>)
+            if (backend != AsyncBackend::ThreadPool) {
+                try {
+                    return std::make_unique<IoUringQueue>(uDepth);
+                } catch (const std::runtime_error&) {
+                    if (backend == AsyncBackend::IoUring)
+                        throw;
+                }
+            }
+#else
+            if (backend == AsyncBackend::IoUring)
+                throw std::runtime_error("io_uring is not available on this platform");
+#endif
+            return std::make_unique<ThreadPoolQueue>(uDepth);
+        }
+
+        class AsyncFileBase :
+            virtual public  StreamState,
+            virtual public  StreamPosition {
+        public:
+            static constexpr size_t
+                uDefaultDepth       = 4,
+                uDefaultBlockSize   = 256 * 1024;
+
+            AsyncFileBase(
+                std::string_view    strvFilename,
+                int                 iFlags,
+                size_t              uDepth,
+                size_t              uBlockSize,
+                AsyncBackend        backend) :
+                uDepth(std::max<size_t>(uDepth, 1)),
+                uBlockSize(std::max<size_t>(uBlockSize, 1)),
+                lpBuffers(new std::byte[this->uDepth * this->uBlockSize]),
+                vecSlots(this->uDepth)
+            {
+                this->fd    = open(std::string(strvFilename).c_str(), iFlags | O_CLOEXEC, 0666);
+                if (this->fd < 0) {
+                    throw std::runtime_error(std::format(
+                        "failed to open file {}: {}",
+                        strvFilename, strerror(errno)));
+                }
+
+                try {
+                    this->queue = MakeAsyncQueue(backend, this->uDepth);
+                } catch (...) {
+                    close(this->fd);
+                    throw;
+                }
+            }
+
+            AsyncFileBase(const AsyncFileBase&) = delete;
+            AsyncFileBase&
+            operator=(const AsyncFileBase&) = delete;
+
+            ~AsyncFileBase() noexcept {
+                this->Drain();
+                close(this->fd);
+            }
+
+            [[nodiscard]] bool
+            EndOfStream() const noexcept override {
+                return this->bEOF;
+            }
+
+            [[nodiscard]] bool
+            Good() const noexcept override {
+                return !this->bErr;
+            }
+
+            void
+            ClearFlags() noexcept override {
+                this->bEOF  = false;
+                this->bErr  = false;
+            }
+
+            [[nodiscard]] int
+            Descriptor() const noexcept {
+                return this->fd;
+            }
+
+            bool
+            Advise(AccessHint hint, uint64_t uOffset = 0, uint64_t uLength = 0) noexcept {
+                return AdviseDescriptor(this->fd, hint, uOffset, uLength);
+            }
+
+        protected:
+            struct Slot {
+                uint64_t
+                    uOffset     = 0;
+                size_t
+                    uSize       = 0;
+                bool
+                    bInFlight   = false;
+            };
+
+            std::byte*
+            Buffer(size_t uSlot) const noexcept {
+                return this->lpBuffers.get() + uSlot * this->uBlockSize;
+            }
+
+            bool
+            Submit(size_t uSlot, bool bWrite, size_t uSize, uint64_t uOffset) {
+                Slot&
+                    slot    = this->vecSlots[uSlot];
+                slot.uOffset    = uOffset;
+                slot.uSize      = uSize;
+                slot.bInFlight  = this->queue->Submit(uSlot, bWrite, this->fd, this->Buffer(uSlot), uSize, uOffset);
+                if (!slot.bInFlight)
+                    this->bErr  = true;
+                return slot.bInFlight;
+            }
+
+            ssize_t
+            Wait(size_t uSlot) {
+                Slot&
+                    slot    = this->vecSlots[uSlot];
+                if (!slot.bInFlight)
+                    return -EINVAL;
+
+                slot.bInFlight  = false;
+                return this->queue->Wait(uSlot);
+            }
+
+            bool
+            Drain() noexcept {
+                bool
+                    bComplete   = true;
+                for (size_t i = 0; i < this->uDepth; ++i) {
+                    if (!this->vecSlots[i].bInFlight)
+                        continue;
+
+                    size_t
+                        uExpected   = this->vecSlots[i].uSize;
+                    if (this->Wait(i) != (ssize_t)uExpected)
+                        bComplete   = false;
+                }
+
+                return bComplete;
+            }
+
+            [[nodiscard]] std::optional<uint64_t>
+            FileSize() const noexcept {
+                struct stat
+                    st;
+                if (fstat(this->fd, &st) != 0)
+                    return std::nullopt;
+                return (uint64_t)st.st_size;
+            }
+
+            int
+                fd          = -1;
+            size_t
+                uDepth      = 0,
+                uBlockSize  = 0;
+            std::unique_ptr<std::byte[]>
+                lpBuffers;
+            std::vector<Slot>
+                vecSlots;
+            std::unique_ptr<AsyncQueue>
+                queue;
+            bool
+                bEOF        = false,
+                bErr        = false;
+        };
+
+        class AsyncIFileBase :
+            public AsyncFileBase {
+        public:
+            AsyncIFileBase(std::string_view strvFilename, size_t uDepth, size_t uBlockSize, AsyncBackend backend) :
+                AsyncFileBase(strvFilename, O_RDONLY, uDepth, uBlockSize, backend)
+            {
+                this->Restart(0);
+            }
+
+            bool
+            Flush() noexcept override {
+                return !this->bErr;
+            }
+
+            // 0 turns dropping off
+            void
+            SetDropBehind(uint64_t uWindow) noexcept {
+                this->dropBehind.uWindow    = uWindow;
+            }
+
+            [[nodiscard]] intptr_t
+            GetPosition() const noexcept override {
+                return (intptr_t)(this->uBlockOffset + this->uBegin);
+            }
+
+            bool
+            SetPosition(
+                intptr_t            offset,
+                StreamOffsetOrigin  from = StreamOffsetOrigin::StreamStart) override
+            {
+                switch (from) {
+                case StreamOffsetOrigin::CurrentPos:
+                    offset  += this->GetPosition();
+                    break;
+
+                case StreamOffsetOrigin::StreamStart:
+                    offset  += 0;
+                    break;
+
+                case StreamOffsetOrigin::StreamEnd: {
+                    std::optional<uint64_t>
+                        optSize = this->FileSize();
+                    if (!optSize)
+                        return false;
+                    offset  += (intptr_t)*optSize;
+                    break;
+                }
+                }
+
+                if (offset < 0)
+                    return false;
+
+                uint64_t
+                    uTarget = (uint64_t)offset;
+                if (uTarget >= this->uBlockOffset && uTarget <= this->uBlockOffset + this->uEnd)
+                    this->uBegin    = (size_t)(uTarget - this->uBlockOffset);
+                else
+                    this->Restart(uTarget);
+
+                this->bEOF  = false;
+                return true;
+            }
+
+        protected:
+            std::optional<std::byte>
+            Read() {
+                if (this->uBegin == this->uEnd && !this->NextBlock())
+                    return std::nullopt;
+
+                return this->Buffer(this->uHead)[this->uBegin++];
+            }
+
+            size_t
+            ReadSome(std::span<std::byte> buffer) {
+                size_t
+                    uRead   = 0;
+                while (uRead != buffer.size()) {
+                    if (this->uBegin == this->uEnd && !this->NextBlock())
+                        break;
+
+                    size_t
+                        uCount  = std::min(buffer.size() - uRead, this->uEnd - this->uBegin);
+                    memcpy(buffer.data() + uRead, this->Buffer(this->uHead) + this->uBegin, uCount);
+                    this->uBegin    += uCount;
+                    uRead           += uCount;
+                }
+
+                return uRead;
+            }
+
+            bool
+            PutBack(std::byte c) {
+                if (this->uBegin == 0)
+                    return false;
+
+                this->Buffer(this->uHead)[--this->uBegin] = c;
+                this->bEOF  = false;
+                return true;
+            }
+
+            std::span<const std::byte>
+            BorrowRead() {
+                if (this->uBegin == this->uEnd && !this->NextBlock())
+                    return {};
+
+                return { this->Buffer(this->uHead) + this->uBegin, this->uEnd - this->uBegin };
+            }
+
+            void
+            Consume(size_t uCount) {
+                this->uBegin    += uCount;
+            }
+
+            size_t
+            ReadAt(uint64_t uOffset, std::span<std::byte> buffer) {
+                return PositionalRead(this->fd, uOffset, buffer);
+            }
+
+        private:
+            void
+            Restart(uint64_t uOffset) {
+                this->Drain();
+
+                this->uHead         = 0;
+                this->uBlockOffset  = uOffset;
+                this->uBegin        = 0;
+                this->uEnd          = 0;
+                this->bHaveBlock    = false;
+                this->bRestart      = false;
+                this->uNextOffset   = uOffset;
+                for (size_t i = 0; i < this->uDepth; ++i) {
+                    if (!this->Submit(i, false, this->uBlockSize, this->uNextOffset))
+                        break;
+                    this->uNextOffset   += this->uBlockSize;
+                }
+            }
+
+            bool
+            NextBlock() {
+                if (this->bRestart) {
+                    this->Restart(this->uBlockOffset + this->uEnd);
+                } else if (this->bHaveBlock) {
+                    this->dropBehind.Advance(this->fd, this->uBlockOffset + this->uEnd);
+                    this->Submit(this->uHead, false, this->uBlockSize, this->uNextOffset);
+                    this->uNextOffset   += this->uBlockSize;
+                    this->uHead         = (this->uHead + 1) % this->uDepth;
+                }
+
+                uint64_t
+                    uOffset = this->vecSlots[this->uHead].uOffset;
+                ssize_t
+                    iResult = this->Wait(this->uHead);
+
+                this->uBlockOffset  = uOffset;
+                this->uBegin        = 0;
+                this->uEnd          = (iResult > 0) ? (size_t)iResult : 0;
+                this->bHaveBlock    = iResult > 0;
+                if (iResult <= 0) {
+                    if (iResult == 0)
+                        this->bEOF  = true;
+                    else
+                        this->bErr  = true;
+                    this->bRestart  = true;
+                    return false;
+                }
+
+                // the blocks queued behind a short read start past the real data
+                if (this->uEnd != this->uBlockSize)
+                    this->bRestart  = true;
+                return true;
+            }
+
+            size_t
+                uHead           = 0,
+                uBegin          = 0,
+                uEnd            = 0;
+            uint64_t
+                uBlockOffset    = 0,
+                uNextOffset     = 0;
+            DropBehind
+                dropBehind;
+            bool
+                bHaveBlock      = false,
+                bRestart        = false;
+        };
+
+        class AsyncOFileBase :
+            public AsyncFileBase {
+        public:
+            AsyncOFileBase(
+                std::string_view    strvFilename,
+                int                 iFlags,
+                size_t              uDepth,
+                size_t              uBlockSize,
+                AsyncBackend        backend) :
+                AsyncFileBase(strvFilename, iFlags, uDepth, uBlockSize, backend) {}
+
+            ~AsyncOFileBase() noexcept {
+                this->Flush();
+            }
+
+            bool
+            Flush() noexcept override {
+                this->SubmitHead();
+                if (!this->Drain())
+                    this->bErr  = true;
+                return !this->bErr;
+            }
+
+            [[nodiscard]] intptr_t
+            GetPosition() const noexcept override {
+                return (intptr_t)(this->uOffset + this->uFill);
+            }
+
+            bool
+            SetPosition(
+                intptr_t            offset,
+                StreamOffsetOrigin  from = StreamOffsetOrigin::StreamStart) override
+            {
+                if (!this->Flush())
+                    return false;
+
+                switch (from) {
+                case StreamOffsetOrigin::CurrentPos:
+                    offset  += (intptr_t)this->uOffset;
+                    break;
+
+                case StreamOffsetOrigin::StreamStart:
+                    offset  += 0;
+                    break;
+
+                case StreamOffsetOrigin::StreamEnd: {
+                    std::optional<uint64_t>
+                        optSize = this->FileSize();
+                    if (!optSize)
+                        return false;
+                    offset  += (intptr_t)*optSize;
+                    break;
+                }
+                }
+
+                if (offset < 0)
+                    return false;
+
+                this->uOffset   = (uint64_t)offset;
+                return true;
+            }
+
+        protected:
+            bool
+            Write(std::byte c) {
+                if (this->uFill == this->uBlockSize && !this->SubmitHead())
+                    return false;
+
+                this->Buffer(this->uHead)[this->uFill++] = c;
+                return true;
+            }
+
+            size_t
+            WriteSome(std::span<const std::byte> buffer) {
+                size_t
+                    uWritten    = 0;
+                while (uWritten != buffer.size()) {
+                    if (this->uFill == this->uBlockSize && !this->SubmitHead())
+                        break;
+
+                    size_t
+                        uCount  = std::min(buffer.size() - uWritten, this->uBlockSize - this->uFill);
+                    memcpy(this->Buffer(this->uHead) + this->uFill, buffer.data() + uWritten, uCount);
+                    this->uFill += uCount;
+                    uWritten    += uCount;
+                }
+
+                return uWritten;
+            }
+
+            std::span<std::byte>
+            BorrowWrite(size_t uMinSize) {
+                if (this->uBlockSize - this->uFill < uMinSize && !this->SubmitHead())
+                    return {};
+                if (this->uBlockSize - this->uFill < std::max<size_t>(uMinSize, 1))
+                    return {};
+
+                return { this->Buffer(this->uHead) + this->uFill, this->uBlockSize - this->uFill };
+            }
+
+            void
+            Commit(size_t uCount) {
+                this->uFill += uCount;
+            }
+
+            size_t
+            WriteAt(uint64_t uOffset, std::span<const std::byte> buffer) {
+                if (!this->Flush())
+                    return 0;
+
+                size_t
+                    uWritten    = PositionalWrite(this->fd, uOffset, buffer);
+                if (uWritten != buffer.size())
+                    this->bErr  = true;
+                return uWritten;
+            }
+
+        private:
+            bool
+            SubmitHead() {
+                if (this->uFill == 0)
+                    return !this->bErr;
+
+                if (!this->Submit(this->uHead, true, this->uFill, this->uOffset))
+                    return false;
+
+                this->uOffset   += this->uFill;
+                this->uFill     = 0;
+                this->uHead     = (this->uHead + 1) % this->uDepth;
+
+                if (this->vecSlots[this->uHead].bInFlight) {
+                    size_t
+                        uExpected   = this->vecSlots[this->uHead].uSize;
+                    if (this->Wait(this->uHead) != (ssize_t)uExpected)
+                        this->bErr  = true;
+                }
+
+                return !this->bErr;
+            }
+
+            size_t
+                uHead   = 0,
+                uFill   = 0;
+            uint64_t
+                uOffset = 0;
+        };
+    }
+
+    class AsyncIFileStream final :
+        public  IStream,
+        public  __impl::AsyncIFileBase {
+    public:
+        AsyncIFileStream(
+            std::string_view    strvFilename,
+            size_t              uDepth      = uDefaultDepth,
+            size_t              uBlockSize  = uDefaultBlockSize,
+            AsyncBackend        backend     = AsyncBackend::Auto) :
+            AsyncIFileBase(strvFilename, uDepth, uBlockSize, backend) {}
+
+        std::optional<std::byte>
+        Read() override {
+            return this->AsyncIFileBase::Read();
+        }
+
+        size_t
+        ReadSome(std::span<std::byte> buffer) override {
+            return this->AsyncIFileBase::ReadSome(buffer);
+        }
+
+        bool
+        PutBack(std::byte c) override {
+            return this->AsyncIFileBase::PutBack(c);
+        }
+
+        std::span<const std::byte>
+        BorrowRead() override {
+            return this->AsyncIFileBase::BorrowRead();
+        }
+
+        void
+        Consume(size_t uCount) override {
+            this->AsyncIFileBase::Consume(uCount);
+        }
+
+        size_t
+        ReadAt(uint64_t uOffset, std::span<std::byte> buffer) override {
+            return this->AsyncIFileBase::ReadAt(uOffset, buffer);
+        }
+    };
+
+    class AsyncOFileStream final :
+        public  OStream,
+        public  __impl::AsyncOFileBase {
+    public:
+        AsyncOFileStream(
+            std::string_view    strvFilename,
+            size_t              uDepth      = uDefaultDepth,
+            size_t              uBlockSize  = uDefaultBlockSize,
+            AsyncBackend        backend     = AsyncBackend::Auto,
+            int                 iFlags      = O_WRONLY | O_CREAT | O_TRUNC) :
+            AsyncOFileBase(strvFilename, iFlags, uDepth, uBlockSize, backend) {}
+
+        bool
+        Write(std::byte c) override {
+            return this->AsyncOFileBase::Write(c);
+        }
+
+        size_t
+        WriteSome(std::span<const std::byte> buffer) override {
+            return this->AsyncOFileBase::WriteSome(buffer);
+        }
+
+        std::span<std::byte>
+        BorrowWrite(size_t uMinSize) override {
+            return this->AsyncOFileBase::BorrowWrite(uMinSize);
+        }
+
+        void
+        Commit(size_t uCount) override {
+            this->AsyncOFileBase::Commit(uCount);
+        }
+
+        size_t
+        WriteAt(uint64_t uOffset, std::span<const std::byte> buffer) override {
+            return this->AsyncOFileBase::WriteAt(uOffset, buffer);
+        }
+    };
+}
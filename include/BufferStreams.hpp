@@ -1,19 +1,570 @@
 #pragma once
-#include <deque>
+#include <vector>
+#include <memory>
+#include <utility>
 #include <cstdint>
+#include <cstring>
+#include <algorithm>
 
 #include "IOStreams.hpp"
 
 
 namespace io {
-    class IOBufferStream :
+    enum class BufferWriteMode {
+        Insert      = 0,    // writes shift the bytes after the cursor
+        Overwrite   = 1     // writes replace bytes in place, appending past the end
+    };
+
+    namespace __impl {
+        class GapBuffer {
+        public:
+            GapBuffer() = default;
+            GapBuffer(std::span<const std::byte> bytes) {
+                this->Insert(0, bytes);
+            }
+
+            GapBuffer(const GapBuffer& obj) :
+                lpData(obj.uCapacity != 0 ? new std::byte[obj.uCapacity] : nullptr),
+                uCapacity(obj.uCapacity),
+                uGapBegin(obj.uGapBegin),
+                uGapEnd(obj.uGapEnd)
+            {
+                if (this->uCapacity != 0)
+                    memcpy(this->lpData.get(), obj.lpData.get(), this->uCapacity);
+            }
+
+            GapBuffer(GapBuffer&& obj) noexcept :
+                lpData(std::move(obj.lpData)),
+                uCapacity(std::exchange(obj.uCapacity, 0)),
+                uGapBegin(std::exchange(obj.uGapBegin, 0)),
+                uGapEnd(std::exchange(obj.uGapEnd, 0)) {}
+
+            GapBuffer&
+            operator=(const GapBuffer& obj) {
+                GapBuffer
+                    temp    = obj;
+                return *this = std::move(temp);
+            }
+
+            GapBuffer&
+            operator=(GapBuffer&& obj) noexcept {
+                this->lpData    = std::move(obj.lpData);
+                this->uCapacity = std::exchange(obj.uCapacity, 0);
+                this->uGapBegin = std::exchange(obj.uGapBegin, 0);
+                this->uGapEnd   = std::exchange(obj.uGapEnd, 0);
+                return *this;
+            }
+
+            [[nodiscard]] size_t
+            Size() const noexcept {
+                return this->uCapacity - (this->uGapEnd - this->uGapBegin);
+            }
+
+            [[nodiscard]] std::byte
+            At(size_t uPos) const noexcept {
+                return (uPos < this->uGapBegin)
+                    ? this->lpData[uPos]
+                    : this->lpData[uPos + (this->uGapEnd - this->uGapBegin)];
+            }
+
+            size_t
+            CopyOut(size_t uPos, std::span<std::byte> buffer) const noexcept {
+                size_t
+                    uSize   = this->Size();
+                if (uPos >= uSize)
+                    return 0;
+
+                size_t
+                    uCount  = std::min(buffer.size(), uSize - uPos),
+                    uFront  = 0;
+                if (uPos < this->uGapBegin) {
+                    uFront  = std::min(uCount, this->uGapBegin - uPos);
+                    memcpy(buffer.data(), this->lpData.get() + uPos, uFront);
+                }
+                if (uFront != uCount) {
+                    size_t
+                        uBack   = uPos + uFront + (this->uGapEnd - this->uGapBegin);
+                    memcpy(buffer.data() + uFront, this->lpData.get() + uBack, uCount - uFront);
+                }
+
+                return uCount;
+            }
+
+            std::span<const std::byte>
+            ReadWindow(size_t uPos) const noexcept {
+                if (uPos < this->uGapBegin)
+                    return { this->lpData.get() + uPos, this->uGapBegin - uPos };
+
+                size_t
+                    uSize   = this->Size();
+                if (uPos >= uSize)
+                    return {};
+
+                return {
+                    this->lpData.get() + uPos + (this->uGapEnd - this->uGapBegin),
+                    uSize - uPos };
+            }
+
+            std::span<std::byte>
+            WriteWindow(size_t uPos, size_t uMinSize) {
+                this->Reserve(std::max<size_t>(uMinSize, 1));
+                this->MoveGap(uPos);
+                return {
+                    this->lpData.get() + this->uGapBegin,
+                    this->uGapEnd - this->uGapBegin };
+            }
+
+            void
+            CommitWindow(size_t uCount) noexcept {
+                this->uGapBegin += uCount;
+            }
+
+            void
+            Insert(size_t uPos, std::span<const std::byte> bytes) {
+                if (bytes.empty())
+                    return;
+
+                this->Reserve(bytes.size());
+                this->MoveGap(uPos);
+                memcpy(this->lpData.get() + this->uGapBegin, bytes.data(), bytes.size());
+                this->uGapBegin += bytes.size();
+            }
+
+            void
+            Insert(size_t uPos, std::byte c) {
+                this->Reserve(1);
+                this->MoveGap(uPos);
+                this->lpData[this->uGapBegin++] = c;
+            }
+
+            size_t
+            CopyIn(size_t uPos, std::span<const std::byte> bytes) noexcept {
+                size_t
+                    uSize   = this->Size();
+                if (uPos >= uSize)
+                    return 0;
+
+                size_t
+                    uCount  = std::min(bytes.size(), uSize - uPos),
+                    uFront  = 0;
+                if (uPos < this->uGapBegin) {
+                    uFront  = std::min(uCount, this->uGapBegin - uPos);
+                    memcpy(this->lpData.get() + uPos, bytes.data(), uFront);
+                }
+                if (uFront != uCount) {
+                    size_t
+                        uBack   = uPos + uFront + (this->uGapEnd - this->uGapBegin);
+                    memcpy(this->lpData.get() + uBack, bytes.data() + uFront, uCount - uFront);
+                }
+
+                return uCount;
+            }
+
+            // false when uPos lies past the end
+            bool
+            Overwrite(size_t uPos, std::span<const std::byte> bytes) {
+                if (uPos > this->Size())
+                    return false;
+
+                size_t
+                    uInPlace    = this->CopyIn(uPos, bytes);
+                this->Insert(uPos + uInPlace, bytes.subspan(uInPlace));
+                return true;
+            }
+
+            size_t
+            Insert(size_t uPos, io::SerialIStream& is, size_t uCount) {
+                size_t
+                    uTotal  = 0,
+                    uChunk  = 256;
+                this->MoveGap(uPos);
+                while (uTotal != uCount) {
+                    size_t
+                        uWanted = std::min(uChunk, uCount - uTotal);
+                    this->Reserve(uWanted);
+
+                    size_t
+                        uRead   = is.ReadSome({
+                                    this->lpData.get() + this->uGapBegin,
+                                    uWanted });
+                    this->uGapBegin += uRead;
+                    uTotal          += uRead;
+                    if (uRead != uWanted)
+                        break;
+
+                    uChunk  = std::min<size_t>(uChunk * 2, 1 << 20);
+                }
+
+                return uTotal;
+            }
+
+            void
+            Erase(size_t uFirst, size_t uLast) noexcept {
+                this->MoveGap(uFirst);
+                this->uGapEnd   += uLast - uFirst;
+            }
+
+            void
+            Clear() noexcept {
+                this->uGapBegin = 0;
+                this->uGapEnd   = this->uCapacity;
+            }
+
+        private:
+            void
+            MoveGap(size_t uPos) noexcept {
+                if (uPos < this->uGapBegin) {
+                    size_t
+                        uDelta  = this->uGapBegin - uPos;
+                    memmove(
+                        this->lpData.get() + this->uGapEnd - uDelta,
+                        this->lpData.get() + uPos,
+                        uDelta);
+                    this->uGapBegin -= uDelta;
+                    this->uGapEnd   -= uDelta;
+                }
+                else if (uPos > this->uGapBegin) {
+                    size_t
+                        uDelta  = uPos - this->uGapBegin;
+                    memmove(
+                        this->lpData.get() + this->uGapBegin,
+                        this->lpData.get() + this->uGapEnd,
+                        uDelta);
+                    this->uGapBegin += uDelta;
+                    this->uGapEnd   += uDelta;
+                }
+            }
+
+            void
+            Reserve(size_t uGapSize) {
+                if (this->uGapEnd - this->uGapBegin >= uGapSize)
+                    return;
+
+                size_t
+                    uSize       = this->Size(),
+                    uBackSize   = this->uCapacity - this->uGapEnd,
+                    uNewCap     = std::max({
+                                    this->uCapacity * 2,
+                                    uSize + uGapSize,
+                                    (size_t)64 });
+                std::unique_ptr<std::byte[]>
+                    lpNewData(new std::byte[uNewCap]);
+                if (this->uGapBegin != 0)
+                    memcpy(lpNewData.get(), this->lpData.get(), this->uGapBegin);
+                if (uBackSize != 0)
+                    memcpy(lpNewData.get() + uNewCap - uBackSize, this->lpData.get() + this->uGapEnd, uBackSize);
+
+                this->lpData    = std::move(lpNewData);
+                this->uCapacity = uNewCap;
+                this->uGapEnd   = uNewCap - uBackSize;
+            }
+
+            std::unique_ptr<std::byte[]>
+                lpData;
+            size_t
+                uCapacity   = 0,
+                uGapBegin   = 0,
+                uGapEnd     = 0;
+        };
+
+        class PieceTable {
+        public:
+            PieceTable() = default;
+            PieceTable(std::span<const std::byte> bytes) {
+                this->Insert(0, bytes);
+            }
+
+            PieceTable(const PieceTable&) = delete;
+            PieceTable(PieceTable&&) noexcept = default;
+
+            PieceTable&
+            operator=(const PieceTable&) = delete;
+            PieceTable&
+            operator=(PieceTable&&) noexcept = default;
+
+            [[nodiscard]] size_t
+            Size() const noexcept {
+                return Total(this->root);
+            }
+
+            std::span<const std::byte>
+            Locate(size_t uPos) const noexcept {
+                const Node*
+                    lpNode  = this->root.get();
+                while (lpNode != nullptr) {
+                    size_t
+                        uLeft   = Total(lpNode->left);
+                    if (uPos < uLeft) {
+                        lpNode  = lpNode->left.get();
+                    }
+                    else if (uPos < uLeft + lpNode->uSize) {
+                        return {
+                            lpNode->lpData + (uPos - uLeft),
+                            lpNode->uSize  - (uPos - uLeft) };
+                    }
+                    else {
+                        uPos    -= uLeft + lpNode->uSize;
+                        lpNode  = lpNode->right.get();
+                    }
+                }
+
+                return {};
+            }
+
+            size_t
+            CopyOut(size_t uPos, std::span<std::byte> buffer) const noexcept {
+                size_t
+                    uCopied = 0;
+                while (uCopied != buffer.size()) {
+                    std::span<const std::byte>
+                        piece   = this->Locate(uPos + uCopied);
+                    if (piece.empty())
+                        break;
+
+                    size_t
+                        uCount  = std::min(piece.size(), buffer.size() - uCopied);
+                    memcpy(buffer.data() + uCopied, piece.data(), uCount);
+                    uCopied += uCount;
+                }
+
+                return uCopied;
+            }
+
+            // pieces never alias each other and always point into our own
+            // blocks, so they can be patched in place without a split
+            size_t
+            CopyIn(size_t uPos, std::span<const std::byte> bytes) noexcept {
+                size_t
+                    uCopied = 0;
+                while (uCopied != bytes.size()) {
+                    std::span<const std::byte>
+                        piece   = this->Locate(uPos + uCopied);
+                    if (piece.empty())
+                        break;
+
+                    size_t
+                        uCount  = std::min(piece.size(), bytes.size() - uCopied);
+                    memcpy(const_cast<std::byte*>(piece.data()), bytes.data() + uCopied, uCount);
+                    uCopied += uCount;
+                }
+
+                return uCopied;
+            }
+
+            void
+            Insert(size_t uPos, std::span<const std::byte> bytes) {
+                if (bytes.empty())
+                    return;
+
+                std::span<std::byte>
+                    spanStore   = this->Reserve(bytes.size());
+                memcpy(spanStore.data(), bytes.data(), bytes.size());
+                this->Commit(bytes.size());
+                this->InsertPiece(uPos, spanStore);
+            }
+
+            size_t
+            Insert(size_t uPos, io::SerialIStream& is, size_t uCount) {
+                size_t
+                    uTotal  = 0;
+                while (uTotal != uCount) {
+                    std::span<std::byte>
+                        spanStore   = this->Reserve(std::min(uCount - uTotal, uBlockSize));
+                    size_t
+                        uRead   = is.ReadSome(spanStore);
+                    this->Commit(uRead);
+                    this->InsertPiece(uPos + uTotal, spanStore.first(uRead));
+                    uTotal          += uRead;
+                    if (uRead != spanStore.size())
+                        break;
+                }
+
+                return uTotal;
+            }
+
+            void
+            Erase(size_t uFirst, size_t uLast) {
+                auto [lpLeft, lpRest]   = Split(std::move(this->root), uFirst);
+                auto [lpMid, lpRight]   = Split(std::move(lpRest), uLast - uFirst);
+                lpMid.reset();
+                this->root  = Merge(std::move(lpLeft), std::move(lpRight));
+            }
+
+            void
+            Clear() noexcept {
+                this->root.reset();
+                this->vecBlocks.clear();
+                this->uTailLeft = 0;
+            }
+
+        private:
+            static constexpr size_t
+                uBlockSize  = 64 * 1024;
+
+            struct Node {
+                const std::byte*
+                    lpData      = nullptr;
+                size_t
+                    uSize       = 0,
+                    uTotal      = 0;
+                uint32_t
+                    uPriority   = 0;
+                std::unique_ptr<Node>
+                    left,
+                    right;
+            };
+
+            using NodePtr   =
+                std::unique_ptr<Node>;
+
+            static size_t
+            Total(const NodePtr& node) noexcept {
+                return (node != nullptr) ? node->uTotal : 0;
+            }
+
+            static void
+            Update(Node& node) noexcept {
+                node.uTotal = Total(node.left) + node.uSize + Total(node.right);
+            }
+
+            static NodePtr
+            Merge(NodePtr lpLeft, NodePtr lpRight) noexcept {
+                if (lpLeft == nullptr)
+                    return lpRight;
+                if (lpRight == nullptr)
+                    return lpLeft;
+
+                if (lpLeft->uPriority > lpRight->uPriority) {
+                    lpLeft->right   = Merge(std::move(lpLeft->right), std::move(lpRight));
+                    Update(*lpLeft);
+                    return lpLeft;
+                }
+                else {
+                    lpRight->left   = Merge(std::move(lpLeft), std::move(lpRight->left));
+                    Update(*lpRight);
+                    return lpRight;
+                }
+            }
+
+            std::pair<NodePtr, NodePtr>
+            Split(NodePtr lpNode, size_t uPos) {
+                if (lpNode == nullptr)
+                    return {};
+
+                size_t
+                    uLeft   = Total(lpNode->left);
+                if (uPos <= uLeft) {
+                    auto [lpA, lpB] = this->Split(std::move(lpNode->left), uPos);
+                    lpNode->left    = std::move(lpB);
+                    Update(*lpNode);
+                    return { std::move(lpA), std::move(lpNode) };
+                }
+                if (uPos >= uLeft + lpNode->uSize) {
+                    auto [lpA, lpB] = this->Split(std::move(lpNode->right), uPos - uLeft - lpNode->uSize);
+                    lpNode->right   = std::move(lpA);
+                    Update(*lpNode);
+                    return { std::move(lpNode), std::move(lpB) };
+                }
+
+                size_t
+                    uOffset = uPos - uLeft;
+                NodePtr
+                    lpTail  = this->MakeNode({
+                                lpNode->lpData + uOffset,
+                                lpNode->uSize  - uOffset });
+                NodePtr
+                    lpRight = std::move(lpNode->right);
+                lpNode->uSize   = uOffset;
+                Update(*lpNode);
+                return { std::move(lpNode), Merge(std::move(lpTail), std::move(lpRight)) };
+            }
+
+            static bool
+            ExtendLast(Node* lpNode, std::span<const std::byte> bytes) noexcept {
+                if (lpNode == nullptr)
+                    return false;
+
+                if (lpNode->right != nullptr) {
+                    if (!ExtendLast(lpNode->right.get(), bytes))
+                        return false;
+                }
+                else if (lpNode->lpData + lpNode->uSize == bytes.data())
+                    lpNode->uSize   += bytes.size();
+                else
+                    return false;
+
+                Update(*lpNode);
+                return true;
+            }
+
+            void
+            InsertPiece(size_t uPos, std::span<const std::byte> bytes) {
+                if (bytes.empty())
+                    return;
+
+                auto [lpLeft, lpRight]  = this->Split(std::move(this->root), uPos);
+                if (!ExtendLast(lpLeft.get(), bytes))
+                    lpLeft  = Merge(std::move(lpLeft), this->MakeNode(bytes));
+                this->root  = Merge(std::move(lpLeft), std::move(lpRight));
+            }
+
+            NodePtr
+            MakeNode(std::span<const std::byte> bytes) {
+                this->uSeed ^= this->uSeed << 13;
+                this->uSeed ^= this->uSeed >> 17;
+                this->uSeed ^= this->uSeed << 5;
+
+                NodePtr
+                    lpNode  = std::make_unique<Node>();
+                lpNode->lpData      = bytes.data();
+                lpNode->uSize       = bytes.size();
+                lpNode->uTotal      = bytes.size();
+                lpNode->uPriority   = this->uSeed;
+                return lpNode;
+            }
+
+            std::span<std::byte>
+            Reserve(size_t uSize) {
+                if (uSize > this->uTailLeft) {
+                    size_t
+                        uNewSize    = std::max(uSize, uBlockSize);
+                    this->vecBlocks.emplace_back(new std::byte[uNewSize]);
+                    this->lpTail    = this->vecBlocks.back().get();
+                    this->uTailLeft = uNewSize;
+                }
+
+                return { this->lpTail, uSize };
+            }
+
+            void
+            Commit(size_t uSize) noexcept {
+                this->lpTail    += uSize;
+                this->uTailLeft -= uSize;
+            }
+
+            NodePtr
+                root;
+            std::vector<std::unique_ptr<std::byte[]>>
+                vecBlocks;
+            std::byte*
+                lpTail      = nullptr;
+            size_t
+                uTailLeft   = 0;
+            uint32_t
+                uSeed       = 2463534242u;
+        };
+    }
+
+    class IOBufferStream final :
         virtual public  __impl::StreamState,
         virtual public  __impl::StreamPosition,
         public io::IOStream {
     public:
-        IOBufferStream() = default;
-        IOBufferStream(std::span<const std::byte> buffer) :
-            deqBuffer(std::from_range, buffer) {}
+        IOBufferStream(BufferWriteMode mode = BufferWriteMode::Insert) :
+            flags_overwrite(mode == BufferWriteMode::Overwrite) {}
+        IOBufferStream(std::span<const std::byte> buffer, BufferWriteMode mode = BufferWriteMode::Insert) :
+            gapBuffer(buffer),
+            flags_overwrite(mode == BufferWriteMode::Overwrite) {}
         
         bool
         EndOfStream() const noexcept override {
@@ -52,13 +603,11 @@ namespace io {
                 break;
 
             case StreamOffsetOrigin::StreamEnd:
-                offset  += (intptr_t)this->deqBuffer.size();
+                offset  += (intptr_t)this->gapBuffer.Size();
                 break;
             }
 
-            auto
-                itNewPos    = this->deqBuffer.begin() + offset;
-            if (itNewPos < this->deqBuffer.begin() || itNewPos >= this->deqBuffer.end())
+            if (offset < 0 || offset > (intptr_t)this->gapBuffer.Size())
                 return false;
 
             this->iCurPos       = offset;
@@ -69,38 +618,36 @@ namespace io {
 
         intptr_t
         Erase(intptr_t iFirst, intptr_t iLast) {
-            return this->deqBuffer.erase(
-                this->deqBuffer.begin() + iFirst,
-                this->deqBuffer.begin() + iLast) - this->deqBuffer.begin();
+            this->gapBuffer.Erase(
+                (size_t)iFirst,
+                (size_t)iLast);
             this->iCurPos   = std::min<intptr_t>(
                                 this->iCurPos,
-                                (intptr_t)this->deqBuffer.size());
+                                (intptr_t)this->gapBuffer.Size());
+            return iFirst;
         }
 
         intptr_t
         Insert(intptr_t iWhere, std::span<const std::byte> bytes) {
-            auto
-                itWhere = this->deqBuffer.begin() + iWhere;
-            this->deqBuffer.insert(
-                itWhere,
-                bytes.begin(),
-                bytes.end());
+            this->gapBuffer.Insert(
+                (size_t)iWhere,
+                bytes);
             return iWhere;
         }
 
         intptr_t
         Insert(intptr_t iWhere, io::SerialIStream& is, size_t uCount = SIZE_MAX) {
-            auto
-                itWhere = this->deqBuffer.begin() + iWhere;
-            for (size_t i = 0; i != uCount; ++i) {
-                std::optional<std::byte>
-                    optc    = is.Read();
-                if (!optc)
-                    break;
-
-                itWhere     = ++this->deqBuffer.insert(itWhere, *optc);
-            }
+            this->gapBuffer.Insert(
+                (size_t)iWhere,
+                is, uCount);
+            return iWhere;
+        }
 
+        // -1 when iWhere lies outside the buffer
+        intptr_t
+        Overwrite(intptr_t iWhere, std::span<const std::byte> bytes) {
+            if (iWhere < 0 || !this->gapBuffer.Overwrite((size_t)iWhere, bytes))
+                return -1;
             return iWhere;
         }
 
@@ -120,17 +667,31 @@ namespace io {
 
         void
         ClearBuffer() {
-            this->deqBuffer.clear();
+            this->gapBuffer.Clear();
             this->iCurPos   = 0;
             this->ClearFlags();
         }
 
+        BufferWriteMode
+        GetWriteMode() const noexcept {
+            return this->flags_overwrite
+                ? BufferWriteMode::Overwrite
+                : BufferWriteMode::Insert;
+        }
+
+        void
+        SetWriteMode(BufferWriteMode mode) noexcept {
+            this->flags_overwrite = (mode == BufferWriteMode::Overwrite);
+        }
+
         bool
         Write(std::byte c) override {
-            auto
-                itCurPos    = this->deqBuffer.begin() + this->iCurPos;
-            this->deqBuffer.insert(
-                itCurPos, c);
+            if (this->flags_overwrite)
+                this->gapBuffer.Overwrite(
+                    (size_t)this->iCurPos, { &c, 1 });
+            else
+                this->gapBuffer.Insert(
+                    (size_t)this->iCurPos, c);
             this->iCurPos   += 1;
 
             this->retbuf_size = 0;
@@ -140,11 +701,13 @@ namespace io {
 
         size_t
         WriteSome(std::span<const std::byte> buffer) override {
-            auto
-                itCurPos    = this->deqBuffer.begin() + this->iCurPos;
-            this->deqBuffer.insert_range(
-                itCurPos, buffer);
-            this->iCurPos   += buffer.size();
+            if (this->flags_overwrite)
+                this->gapBuffer.Overwrite(
+                    (size_t)this->iCurPos, buffer);
+            else
+                this->gapBuffer.Insert(
+                    (size_t)this->iCurPos, buffer);
+            this->iCurPos   += (intptr_t)buffer.size();
 
             this->retbuf_size = 0;
             this->ClearFlags();
@@ -158,12 +721,9 @@ namespace io {
                 return this->retbuf[this->retbuf_size];
             }
 
-            auto
-                itCurr  = this->deqBuffer.begin() + this->iCurPos,
-                itEnd   = this->deqBuffer.end();
-            if (itCurr != itEnd) {
-                this->iCurPos   += 1;
-                return *itCurr;
+            if ((size_t)this->iCurPos < this->gapBuffer.Size()) {
+                return this->gapBuffer.At(
+                    (size_t)this->iCurPos++);
             }
 
             this->flags_eof = true;
@@ -172,19 +732,279 @@ namespace io {
 
         size_t
         ReadSome(std::span<std::byte> buffer) override {
-            for (size_t i = 0; i != buffer.size(); ++i) {
-                std::optional<std::byte>
-                    c   = this->Read();
-                if (!c.has_value()) {
-                    return i;
-                }
+            size_t
+                uRead   = 0;
+            while (this->retbuf_size != 0 && uRead != buffer.size()) {
+                this->retbuf_size -= 1;
+                buffer[uRead++] = this->retbuf[this->retbuf_size];
+            }
+
+            size_t
+                uCopied = this->gapBuffer.CopyOut(
+                            (size_t)this->iCurPos,
+                            buffer.subspan(uRead));
+            this->iCurPos   += (intptr_t)uCopied;
+            uRead           += uCopied;
+            if (uRead != buffer.size())
+                this->flags_eof = true;
 
-                buffer[i] = *c;
+            return uRead;
+        }
+
+        bool
+        PutBack(std::byte c) override {
+            if (this->retbuf_size < sizeof(this->retbuf)) {
+                this->retbuf[this->retbuf_size] = c;
+                this->retbuf_size += 1;
+                this->ClearFlags();
+                return true;
             }
+            else
+                return false;
+        }
+
+        std::span<const std::byte>
+        BorrowRead() override {
+            if (this->retbuf_size != 0)
+                return {};
+
+            return this->gapBuffer.ReadWindow(
+                (size_t)this->iCurPos);
+        }
 
+        void
+        Consume(size_t uCount) override {
+            this->iCurPos   += (intptr_t)uCount;
+        }
+
+        // the window is the gap itself, so overwriting gets none: moving the
+        // gap to patch a few bytes would shift everything behind them
+        std::span<std::byte>
+        BorrowWrite(size_t uMinSize) override {
+            if (this->flags_overwrite)
+                return {};
+
+            return this->gapBuffer.WriteWindow(
+                (size_t)this->iCurPos, uMinSize);
+        }
+
+        void
+        Commit(size_t uCount) override {
+            this->gapBuffer.CommitWindow(uCount);
+            this->iCurPos   += (intptr_t)uCount;
+
+            this->retbuf_size = 0;
+            this->ClearFlags();
+        }
+
+        size_t
+        ReadAt(uint64_t uOffset, std::span<std::byte> buffer) override {
+            return this->gapBuffer.CopyOut(
+                (size_t)uOffset, buffer);
+        }
+
+        size_t
+        WriteAt(uint64_t uOffset, std::span<const std::byte> buffer) override {
+            return this->gapBuffer.CopyIn(
+                (size_t)uOffset, buffer);
+        }
+
+    private:
+        __impl::GapBuffer
+            gapBuffer;
+        intptr_t
+            iCurPos = 0;
+        
+        struct {
+            std::byte
+                retbuf[alignof(intptr_t) - 2];
+            uint8_t
+                retbuf_size     : 7 = 0,
+                flags_eof       : 1 = false;
+            bool
+                flags_overwrite     = false;
+        };
+    };
+
+    class IOPieceTableStream final :
+        virtual public  __impl::StreamState,
+        virtual public  __impl::StreamPosition,
+        public io::IOStream {
+    public:
+        IOPieceTableStream() = default;
+        IOPieceTableStream(std::span<const std::byte> buffer) :
+            pieceTable(buffer) {}
+
+        bool
+        EndOfStream() const noexcept override {
+            return this->flags_eof;
+        }
+
+        bool
+        Good() const noexcept override {
+            return true;
+        }
+
+        intptr_t
+        GetPosition() const noexcept override {
+            return this->iCurPos;
+        }
+
+        void
+        ClearFlags() noexcept override {
+            this->flags_eof = false;
+        }
+
+        bool
+        Flush() noexcept override {
+            return true;
+        }
+
+        bool
+        SetPosition(intptr_t offset, StreamOffsetOrigin from = StreamOffsetOrigin::StreamStart) override {
+            switch(from) {
+            case StreamOffsetOrigin::CurrentPos:
+                offset  += this->iCurPos;
+                break;
+            
+            case StreamOffsetOrigin::StreamStart:
+                offset  += 0;
+                break;
+
+            case StreamOffsetOrigin::StreamEnd:
+                offset  += (intptr_t)this->pieceTable.Size();
+                break;
+            }
+
+            if (offset < 0 || offset > (intptr_t)this->pieceTable.Size())
+                return false;
+
+            this->iCurPos       = offset;
+            this->spanCursor    = {};
+            this->flags_eof     = false;
+            this->retbuf_size   = 0;
+            return true;
+        }
+
+        intptr_t
+        Erase(intptr_t iFirst, intptr_t iLast) {
+            this->pieceTable.Erase(
+                (size_t)iFirst,
+                (size_t)iLast);
+            this->iCurPos       = std::min<intptr_t>(
+                                    this->iCurPos,
+                                    (intptr_t)this->pieceTable.Size());
+            this->spanCursor    = {};
+            return iFirst;
+        }
+
+        intptr_t
+        Insert(intptr_t iWhere, std::span<const std::byte> bytes) {
+            this->pieceTable.Insert(
+                (size_t)iWhere,
+                bytes);
+            this->spanCursor    = {};
+            return iWhere;
+        }
+
+        intptr_t
+        Insert(intptr_t iWhere, io::SerialIStream& is, size_t uCount = SIZE_MAX) {
+            this->pieceTable.Insert(
+                (size_t)iWhere,
+                is, uCount);
+            this->spanCursor    = {};
+            return iWhere;
+        }
+
+        intptr_t
+        Replace(intptr_t iFirst, intptr_t iLast, std::span<const std::byte> bytes) {
+            return this->Insert(
+                this->Erase(iFirst, iLast),
+                bytes);
+        }
+
+        intptr_t
+        Replace(intptr_t iFirst, intptr_t iLast, io::SerialIStream& is, size_t uCount = SIZE_MAX) {
+            return this->Insert(
+                this->Erase(iFirst, iLast),
+                is, uCount);
+        }
+
+        void
+        ClearBuffer() {
+            this->pieceTable.Clear();
+            this->iCurPos       = 0;
+            this->spanCursor    = {};
+            this->ClearFlags();
+        }
+
+        bool
+        Write(std::byte c) override {
+            return this->WriteSome({ &c, 1 }) == 1;
+        }
+
+        size_t
+        WriteSome(std::span<const std::byte> buffer) override {
+            this->pieceTable.Insert(
+                (size_t)this->iCurPos, buffer);
+            this->iCurPos       += (intptr_t)buffer.size();
+            this->spanCursor    = {};
+
+            this->retbuf_size = 0;
+            this->ClearFlags();
             return buffer.size();
         }
 
+        std::optional<std::byte>
+        Read() override {
+            if (this->retbuf_size != 0) {
+                this->retbuf_size -= 1;
+                return this->retbuf[this->retbuf_size];
+            }
+
+            if (this->spanCursor.empty())
+                this->spanCursor    = this->pieceTable.Locate((size_t)this->iCurPos);
+
+            if (!this->spanCursor.empty()) {
+                std::byte
+                    c   = this->spanCursor.front();
+                this->spanCursor    = this->spanCursor.subspan(1);
+                this->iCurPos       += 1;
+                return c;
+            }
+
+            this->flags_eof = true;
+            return std::nullopt;
+        }
+
+        size_t
+        ReadSome(std::span<std::byte> buffer) override {
+            size_t
+                uRead   = 0;
+            while (this->retbuf_size != 0 && uRead != buffer.size()) {
+                this->retbuf_size -= 1;
+                buffer[uRead++] = this->retbuf[this->retbuf_size];
+            }
+
+            while (uRead != buffer.size()) {
+                if (this->spanCursor.empty())
+                    this->spanCursor    = this->pieceTable.Locate((size_t)this->iCurPos);
+                if (this->spanCursor.empty()) {
+                    this->flags_eof = true;
+                    break;
+                }
+
+                size_t
+                    uCount  = std::min(buffer.size() - uRead, this->spanCursor.size());
+                memcpy(buffer.data() + uRead, this->spanCursor.data(), uCount);
+                this->spanCursor    = this->spanCursor.subspan(uCount);
+                this->iCurPos       += (intptr_t)uCount;
+                uRead               += uCount;
+            }
+
+            return uRead;
+        }
+
         bool
         PutBack(std::byte c) override {
             if (this->retbuf_size < sizeof(this->retbuf)) {
@@ -197,12 +1017,42 @@ namespace io {
                 return false;
         }
 
+        std::span<const std::byte>
+        BorrowRead() override {
+            if (this->retbuf_size != 0)
+                return {};
+
+            if (this->spanCursor.empty())
+                this->spanCursor    = this->pieceTable.Locate((size_t)this->iCurPos);
+            return this->spanCursor;
+        }
+
+        void
+        Consume(size_t uCount) override {
+            this->spanCursor    = this->spanCursor.subspan(uCount);
+            this->iCurPos       += (intptr_t)uCount;
+        }
+
+        size_t
+        ReadAt(uint64_t uOffset, std::span<std::byte> buffer) override {
+            return this->pieceTable.CopyOut(
+                (size_t)uOffset, buffer);
+        }
+
+        size_t
+        WriteAt(uint64_t uOffset, std::span<const std::byte> buffer) override {
+            return this->pieceTable.CopyIn(
+                (size_t)uOffset, buffer);
+        }
+
     private:
-        std::deque<std::byte>
-            deqBuffer;
+        __impl::PieceTable
+            pieceTable;
         intptr_t
             iCurPos = 0;
-        
+        std::span<const std::byte>
+            spanCursor;
+
         struct {
             std::byte
                 retbuf[alignof(intptr_t) - 1];
@@ -212,4 +1062,3 @@ namespace io {
         };
     };
 }
-
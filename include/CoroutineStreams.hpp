@@ -0,0 +1,1177 @@
+#pragma once
+#include <deque>
+#include <atomic>
+#include <string>
+#include <vector>
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <utility>
+#include <optional>
+#include <charconv>
+#include <coroutine>
+#include <exception>
+#include <stdexcept>
+#include <unordered_map>
+#include <unordered_set>
+
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/eventfd.h>
+
+#include "IOReadWrite.hpp"
+#include "ReactorStreams.hpp"
+
+
+namespace io {
+    template<typename T = void>
+    class Task;
+
+    class NetworkScheduler;
+
+    namespace __impl {
+        class TaskPromiseBase {
+        public:
+            struct FinalAwaiter {
+                bool
+                await_ready() const noexcept {
+                    return false;
+                }
+
+                // hands control back to whoever awaited the task; a spawned
+                // one reports itself finished to its scheduler instead
+                template<typename PromiseT>
+                std::coroutine_handle<>
+                await_suspend(std::coroutine_handle<PromiseT> hCoroutine) noexcept {
+                    TaskPromiseBase&
+                        promise = hCoroutine.promise();
+                    if (promise.hContinuation)
+                        return promise.hContinuation;
+
+                    if (promise.lpFinished != nullptr)
+                        promise.lpFinished->push_back(hCoroutine);
+                    return std::noop_coroutine();
+                }
+
+                void
+                await_resume() const noexcept {}
+            };
+
+            std::suspend_always
+            initial_suspend() const noexcept {
+                return {};
+            }
+
+            FinalAwaiter
+            final_suspend() const noexcept {
+                return {};
+            }
+
+            void
+            unhandled_exception() noexcept {
+                this->exception = std::current_exception();
+            }
+
+            std::coroutine_handle<>
+                hContinuation;
+            std::exception_ptr
+                exception;
+            std::vector<std::coroutine_handle<>>*
+                lpFinished  = nullptr;
+        };
+
+        template<typename T>
+        class TaskPromise :
+            public TaskPromiseBase {
+        public:
+            Task<T>
+            get_return_object() noexcept;
+
+            template<typename V> requires
+                std::convertible_to<V, T>
+            void
+            return_value(V&& value) {
+                this->optValue.emplace(std::forward<V>(value));
+            }
+
+            T
+            Result() {
+                if (this->exception)
+                    std::rethrow_exception(this->exception);
+                return std::move(*this->optValue);
+            }
+
+        private:
+            std::optional<T>
+                optValue;
+        };
+
+        template<>
+        class TaskPromise<void> :
+            public TaskPromiseBase {
+        public:
+            Task<void>
+            get_return_object() noexcept;
+
+            void
+            return_void() const noexcept {}
+
+            void
+            Result() {
+                if (this->exception)
+                    std::rethrow_exception(this->exception);
+            }
+        };
+    }
+
+    // a lazily started coroutine: it runs once awaited, or once spawned on
+    // a scheduler, and hands its result or exception to the awaiter
+    template<typename T>
+    class Task {
+    public:
+        using promise_type  =
+            __impl::TaskPromise<T>;
+
+        Task(const Task&) = delete;
+
+        Task(Task&& obj) noexcept :
+            hCoroutine(std::exchange(obj.hCoroutine, {})) {}
+
+        Task&
+        operator=(const Task&) = delete;
+
+        Task&
+        operator=(Task&& obj) noexcept {
+            Task
+                temp    = std::move(obj);
+            std::swap(this->hCoroutine, temp.hCoroutine);
+            return *this;
+        }
+
+        ~Task() noexcept {
+            if (this->hCoroutine)
+                this->hCoroutine.destroy();
+        }
+
+        bool
+        await_ready() const noexcept {
+            return !this->hCoroutine || this->hCoroutine.done();
+        }
+
+        std::coroutine_handle<>
+        await_suspend(std::coroutine_handle<> hAwaiting) noexcept {
+            this->hCoroutine.promise().hContinuation = hAwaiting;
+            return this->hCoroutine;
+        }
+
+        T
+        await_resume() {
+            return this->hCoroutine.promise().Result();
+        }
+
+    private:
+        friend promise_type;
+        friend class NetworkScheduler;
+
+        explicit Task(std::coroutine_handle<promise_type> hCoroutine) noexcept :
+            hCoroutine(hCoroutine) {}
+
+        std::coroutine_handle<promise_type>
+            hCoroutine;
+    };
+
+    namespace __impl {
+        template<typename T>
+        inline Task<T>
+        TaskPromise<T>::get_return_object() noexcept {
+            return Task<T>(std::coroutine_handle<TaskPromise>::from_promise(*this));
+        }
+
+        inline Task<void>
+        TaskPromise<void>::get_return_object() noexcept {
+            return Task<void>(std::coroutine_handle<TaskPromise>::from_promise(*this));
+        }
+
+        // a socket call that is retried in place each time its descriptor
+        // turns ready, so awaiting one doesn't allocate a frame of its own
+        class PendingOperation {
+        public:
+            PendingOperation(const PendingOperation&) = delete;
+            PendingOperation&
+            operator=(const PendingOperation&) = delete;
+
+            virtual ~PendingOperation() noexcept;
+
+            bool
+            await_ready() {
+                return this->Attempt();
+            }
+
+            bool
+            await_suspend(std::coroutine_handle<> hAwaiting);
+
+            // true once the call is done, false to wait for readiness again,
+            // or, with bStarved set, until the scheduler sees a descriptor
+            // released: out of descriptors, readiness alone won't help
+            virtual bool
+            Attempt() = 0;
+
+        protected:
+            PendingOperation(NetworkScheduler& scheduler, int fd, bool bWrite) noexcept :
+                refScheduler(scheduler),
+                fd(fd),
+                bWrite(bWrite) {}
+
+            NetworkScheduler&
+                refScheduler;
+            int
+                fd          = -1;
+            bool
+                bWrite      = false,
+                bWaiting    = false,
+                bStarved    = false;
+            std::coroutine_handle<>
+                hAwaiting;
+
+            friend class io::NetworkScheduler;
+        };
+    }
+
+    // resumes coroutines as their sockets turn ready, all on the thread
+    // calling Run(). every descriptor takes one waiting reader and one
+    // waiting writer at a time, which is what a connection's task needs
+    class NetworkScheduler {
+    public:
+        NetworkScheduler() :
+            fdEpoll(epoll_create1(EPOLL_CLOEXEC)),
+            fdWake(eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC))
+        {
+            struct epoll_event
+                event   = {};
+            event.events    = EPOLLIN;
+            event.data.fd   = this->fdWake;
+            if (this->fdEpoll < 0 || this->fdWake < 0 ||
+                epoll_ctl(this->fdEpoll, EPOLL_CTL_ADD, this->fdWake, &event) != 0)
+            {
+                this->CloseDescriptors();
+                throw std::runtime_error("failed to set up the event loop");
+            }
+        }
+
+        NetworkScheduler(const NetworkScheduler&) = delete;
+        NetworkScheduler&
+        operator=(const NetworkScheduler&) = delete;
+
+        ~NetworkScheduler() noexcept {
+            // unfinished tasks are destroyed while their sockets can still
+            // be forgotten
+            for (void* lpTask : this->setTasks)
+                std::coroutine_handle<>::from_address(lpTask).destroy();
+
+            this->setTasks.clear();
+            this->vecFinished.clear();
+            this->dequeReady.clear();
+            this->mapWatchers.clear();
+            this->CloseDescriptors();
+        }
+
+        // takes the task over and starts it on the next round
+        void
+        Spawn(Task<void> task) {
+            std::coroutine_handle<__impl::TaskPromise<void>>
+                hTask   = std::exchange(task.hCoroutine, {});
+            if (!hTask)
+                return;
+
+            this->setTasks.insert(hTask.address());
+            // finishing must not allocate, so make room ahead of time
+            this->vecFinished.reserve(this->setTasks.size());
+            hTask.promise().lpFinished  = &this->vecFinished;
+            this->dequeReady.push_back(hTask);
+        }
+
+        [[nodiscard]] size_t
+        Tasks() const noexcept {
+            return this->setTasks.size();
+        }
+
+        // runs what's ready, then waits up to iTimeoutMs (-1 for ever) for
+        // sockets and runs what they woke. a spawned task's exception is
+        // rethrown here once it has finished
+        bool
+        RunOnce(int iTimeoutMs = -1) {
+            this->ResumeReady();
+            if (this->setTasks.empty())
+                return true;
+
+            // descriptors can be freed where Forget() never hears of it, so
+            // starved operations also get a retry every iStarvedRetryMs
+            if (!this->vecStarved.empty() && (iTimeoutMs < 0 || iTimeoutMs > iStarvedRetryMs))
+                iTimeoutMs  = iStarvedRetryMs;
+
+            struct epoll_event
+                lpEvents[uMaxEvents];
+            int
+                iCount  = epoll_wait(this->fdEpoll, lpEvents, (int)uMaxEvents, iTimeoutMs);
+            if (iCount < 0)
+                return errno == EINTR;
+
+            if (!this->vecStarved.empty() && std::chrono::steady_clock::now() >= this->tpStarvedRetry)
+                this->bReleased = true;
+
+            for (int i = 0; i != iCount; ++i) {
+                int
+                    fd  = lpEvents[i].data.fd;
+                if (fd == this->fdWake) {
+                    uint64_t
+                        uCount  = 0;
+                    (void)read(this->fdWake, &uCount, sizeof(uCount));
+                    continue;
+                }
+
+                auto
+                    it  = this->mapWatchers.find(fd);
+                if (it != this->mapWatchers.end())
+                    this->Dispatch(fd, it->second, lpEvents[i].events);
+            }
+
+            this->ResumeReady();
+            return true;
+        }
+
+        // until every task has finished or Stop() is called
+        void
+        Run() {
+            this->bStop.store(false, std::memory_order_relaxed);
+            while (!this->setTasks.empty() && !this->bStop.load(std::memory_order_relaxed)) {
+                if (!this->RunOnce())
+                    break;
+            }
+        }
+
+        // safe to call from any thread, including tasks
+        void
+        Stop() noexcept {
+            this->bStop.store(true, std::memory_order_relaxed);
+            uint64_t
+                uCount  = 1;
+            (void)write(this->fdWake, &uCount, sizeof(uCount));
+        }
+
+        // for descriptors about to be closed
+        void
+        Forget(int fd) noexcept {
+            this->bReleased = true;
+            if (this->mapWatchers.erase(fd) != 0)
+                epoll_ctl(this->fdEpoll, EPOLL_CTL_DEL, fd, nullptr);
+        }
+
+    private:
+        friend class __impl::PendingOperation;
+
+        static constexpr size_t
+            uMaxEvents      = 256;
+        static constexpr int
+            iStarvedRetryMs = 100;
+
+        struct Watcher {
+            __impl::PendingOperation*
+                lpReader    = nullptr;
+            __impl::PendingOperation*
+                lpWriter    = nullptr;
+        };
+
+        bool
+        Watch(__impl::PendingOperation& operation) {
+            if (operation.bStarved) {
+                this->Park(operation);
+                operation.bWaiting  = true;
+                return true;
+            }
+
+            Watcher&
+                watcher = this->mapWatchers[operation.fd];
+            __impl::PendingOperation*&
+                lpSlot  = operation.bWrite ? watcher.lpWriter : watcher.lpReader;
+            if (lpSlot != nullptr)
+                throw std::runtime_error("another coroutine is already waiting on this socket");
+
+            lpSlot  = &operation;
+            if (!this->Arm(operation.fd, watcher)) {
+                lpSlot  = nullptr;
+                return false;
+            }
+
+            operation.bWaiting  = true;
+            return true;
+        }
+
+        void
+        Cancel(__impl::PendingOperation& operation) noexcept {
+            auto
+                it  = this->mapWatchers.find(operation.fd);
+            if (it != this->mapWatchers.end()) {
+                if (it->second.lpReader == &operation)
+                    it->second.lpReader = nullptr;
+                if (it->second.lpWriter == &operation)
+                    it->second.lpWriter = nullptr;
+            }
+
+            std::erase(this->vecStarved, &operation);
+            operation.bWaiting  = false;
+        }
+
+        // one-shot, so a socket only reports again once someone waits on it
+        bool
+        Arm(int fd, const Watcher& watcher) noexcept {
+            struct epoll_event
+                event   = {};
+            event.events    = EPOLLONESHOT;
+            if (watcher.lpReader != nullptr)
+                event.events    |= EPOLLIN | EPOLLRDHUP;
+            if (watcher.lpWriter != nullptr)
+                event.events    |= EPOLLOUT;
+            event.data.fd   = fd;
+
+            if (epoll_ctl(this->fdEpoll, EPOLL_CTL_MOD, fd, &event) == 0)
+                return true;
+            return errno == ENOENT && epoll_ctl(this->fdEpoll, EPOLL_CTL_ADD, fd, &event) == 0;
+        }
+
+        void
+        Dispatch(int fd, Watcher& watcher, uint32_t uEvents) {
+            if (uEvents & (EPOLLIN | EPOLLRDHUP | EPOLLHUP | EPOLLERR))
+                this->Retry(watcher.lpReader);
+            if (uEvents & (EPOLLOUT | EPOLLHUP | EPOLLERR))
+                this->Retry(watcher.lpWriter);
+
+            if ((watcher.lpReader != nullptr || watcher.lpWriter != nullptr) && !this->Arm(fd, watcher)) {
+                // nothing would wake them any more, let them see the failure
+                this->Complete(watcher.lpReader);
+                this->Complete(watcher.lpWriter);
+            }
+        }
+
+        void
+        Retry(__impl::PendingOperation*& lpOperation) {
+            if (lpOperation == nullptr)
+                return;
+
+            if (lpOperation->Attempt()) {
+                this->Complete(lpOperation);
+            } else if (lpOperation->bStarved) {
+                // parked, the descriptor isn't re-armed for it
+                this->Park(*lpOperation);
+                lpOperation = nullptr;
+            }
+        }
+
+        void
+        Park(__impl::PendingOperation& operation) {
+            if (this->vecStarved.empty())
+                this->tpStarvedRetry    = std::chrono::steady_clock::now() + std::chrono::milliseconds(iStarvedRetryMs);
+            this->vecStarved.push_back(&operation);
+        }
+
+        // gives starved operations another go once some task has released
+        // a descriptor, or the retry interval is up; true if that made a
+        // coroutine ready
+        bool
+        RetryStarved() {
+            if (!std::exchange(this->bReleased, false) || this->vecStarved.empty())
+                return false;
+
+            std::vector<__impl::PendingOperation*>
+                vecRetry    = std::exchange(this->vecStarved, {});
+            for (__impl::PendingOperation* lpOperation : vecRetry) {
+                lpOperation->bStarved   = false;
+                lpOperation->bWaiting   = false;
+                if (lpOperation->Attempt() || !this->Watch(*lpOperation))
+                    this->dequeReady.push_back(lpOperation->hAwaiting);
+            }
+
+            return !this->dequeReady.empty();
+        }
+
+        void
+        Complete(__impl::PendingOperation*& lpOperation) {
+            if (lpOperation == nullptr)
+                return;
+
+            lpOperation->bWaiting   = false;
+            this->dequeReady.push_back(lpOperation->hAwaiting);
+            lpOperation = nullptr;
+        }
+
+        void
+        ResumeReady() {
+            // finished tasks release their sockets when reaped, which is
+            // what starved operations wait for
+            do {
+                while (!this->dequeReady.empty()) {
+                    std::coroutine_handle<>
+                        hCoroutine  = this->dequeReady.front();
+                    this->dequeReady.pop_front();
+                    hCoroutine.resume();
+                }
+
+                this->Reap();
+            } while (this->RetryStarved());
+        }
+
+        void
+        Reap() {
+            std::exception_ptr
+                exception;
+            for (std::coroutine_handle<> hTask : this->vecFinished) {
+                __impl::TaskPromise<void>&
+                    promise = std::coroutine_handle<__impl::TaskPromise<void>>::from_address(hTask.address()).promise();
+                if (!exception)
+                    exception   = promise.exception;
+
+                this->setTasks.erase(hTask.address());
+                hTask.destroy();
+            }
+
+            this->vecFinished.clear();
+            if (exception)
+                std::rethrow_exception(exception);
+        }
+
+        void
+        CloseDescriptors() noexcept {
+            if (this->fdEpoll >= 0)
+                close(this->fdEpoll);
+            if (this->fdWake >= 0)
+                close(this->fdWake);
+            this->fdEpoll   = -1;
+            this->fdWake    = -1;
+        }
+
+        int
+            fdEpoll     = -1,
+            fdWake      = -1;
+        std::atomic<bool>
+            bStop       = false;
+        bool
+            bReleased   = false;
+        std::chrono::steady_clock::time_point
+            tpStarvedRetry;
+        std::unordered_set<void*>
+            setTasks;
+        std::vector<std::coroutine_handle<>>
+            vecFinished;
+        std::deque<std::coroutine_handle<>>
+            dequeReady;
+        std::unordered_map<int, Watcher>
+            mapWatchers;
+        std::vector<__impl::PendingOperation*>
+            vecStarved;
+    };
+
+    namespace __impl {
+        inline
+        PendingOperation::~PendingOperation() noexcept {
+            if (this->bWaiting)
+                this->refScheduler.Cancel(*this);
+        }
+
+        inline bool
+        PendingOperation::await_suspend(std::coroutine_handle<> hAwaiting) {
+            this->hAwaiting = hAwaiting;
+            return this->refScheduler.Watch(*this);
+        }
+
+        // a connection about to wait for input with nothing buffered either
+        // way hands its buffers back to the pool until it's woken
+        inline void
+        ReleaseIdle(BufferedNetworkStream& stream) noexcept {
+            if (stream.BufferedInput() == 0 && stream.PendingOutput() == 0)
+                stream.Trim();
+        }
+
+        class ReadSomeOperation final :
+            public PendingOperation {
+        public:
+            ReadSomeOperation(NetworkScheduler& scheduler, BufferedNetworkStream& stream, std::span<std::byte> buffer) noexcept :
+                PendingOperation(scheduler, stream.Descriptor(), false),
+                refStream(stream),
+                buffer(buffer) {}
+
+            bool
+            Attempt() noexcept override {
+                this->uRead = this->refStream.ReadSome(this->buffer);
+                if (this->uRead != 0 || this->buffer.empty() || !this->refStream.WouldBlock())
+                    return true;
+
+                ReleaseIdle(this->refStream);
+                return false;
+            }
+
+            size_t
+            await_resume() const noexcept {
+                return this->uRead;
+            }
+
+        private:
+            BufferedNetworkStream&
+                refStream;
+            std::span<std::byte>
+                buffer;
+            size_t
+                uRead   = 0;
+        };
+
+        class WriteSomeOperation final :
+            public PendingOperation {
+        public:
+            WriteSomeOperation(NetworkScheduler& scheduler, BufferedNetworkStream& stream, std::span<const std::byte> buffer) noexcept :
+                PendingOperation(scheduler, stream.Descriptor(), true),
+                refStream(stream),
+                buffer(buffer) {}
+
+            bool
+            Attempt() noexcept override {
+                this->uWritten  += this->refStream.WriteSome(this->buffer.subspan(this->uWritten));
+                return this->uWritten == this->buffer.size() || !this->refStream.WouldBlock();
+            }
+
+            size_t
+            await_resume() const noexcept {
+                return this->uWritten;
+            }
+
+        private:
+            BufferedNetworkStream&
+                refStream;
+            std::span<const std::byte>
+                buffer;
+            size_t
+                uWritten    = 0;
+        };
+
+        class FlushOperation final :
+            public PendingOperation {
+        public:
+            FlushOperation(NetworkScheduler& scheduler, BufferedNetworkStream& stream) noexcept :
+                PendingOperation(scheduler, stream.Descriptor(), true),
+                refStream(stream) {}
+
+            bool
+            Attempt() noexcept override {
+                this->bFlushed  = this->refStream.Flush();
+                return this->bFlushed || !this->refStream.WouldBlock();
+            }
+
+            bool
+            await_resume() const noexcept {
+                return this->bFlushed;
+            }
+
+        private:
+            BufferedNetworkStream&
+                refStream;
+            bool
+                bFlushed    = false;
+        };
+
+        class ReceiveOperation final :
+            public PendingOperation {
+        public:
+            ReceiveOperation(NetworkScheduler& scheduler, BufferedNetworkStream& stream) noexcept :
+                PendingOperation(scheduler, stream.Descriptor(), false),
+                refStream(stream) {}
+
+            bool
+            Attempt() noexcept override {
+                this->bReceived = this->refStream.Receive();
+                if (this->bReceived || !this->refStream.WouldBlock())
+                    return true;
+
+                ReleaseIdle(this->refStream);
+                return false;
+            }
+
+            bool
+            await_resume() const noexcept {
+                return this->bReceived;
+            }
+
+        private:
+            BufferedNetworkStream&
+                refStream;
+            bool
+                bReceived   = false;
+        };
+    }
+
+    // a connection driven by coroutines. the socket runs non-blocking and
+    // the Async calls suspend the caller until it's ready; Stream() still
+    // offers the buffered interface, but writes there that outgrow the
+    // output buffer fail rather than wait, so large ones go through
+    // AsyncWriteSome and replies end with AsyncFlush
+    class AsyncNetworkStream {
+    public:
+        AsyncNetworkStream(NetworkScheduler& scheduler, IONetworkStream&& stream) :
+            lpScheduler(&scheduler),
+            ioStream(std::move(stream))
+        {
+            if (!__impl::SetNonBlocking(this->ioStream.Handle()->Descriptor()))
+                throw std::runtime_error("failed to switch the socket to non-blocking mode");
+        }
+
+        AsyncNetworkStream(const AsyncNetworkStream&) = delete;
+        AsyncNetworkStream(AsyncNetworkStream&&) noexcept = default;
+
+        AsyncNetworkStream&
+        operator=(const AsyncNetworkStream&) = delete;
+        AsyncNetworkStream&
+        operator=(AsyncNetworkStream&&) = delete;
+
+        ~AsyncNetworkStream() noexcept {
+            if (this->ioStream.Handle() != nullptr)
+                this->lpScheduler->Forget(this->ioStream.Handle()->Descriptor());
+        }
+
+        // resumes with the bytes read, 0 only at the end of input or on error
+        [[nodiscard]] __impl::ReadSomeOperation
+        AsyncReadSome(std::span<std::byte> buffer) {
+            return { *this->lpScheduler, *this->ioStream.Handle(), buffer };
+        }
+
+        // resumes once all of the span is taken, or with less on error
+        [[nodiscard]] __impl::WriteSomeOperation
+        AsyncWriteSome(std::span<const std::byte> buffer) {
+            return { *this->lpScheduler, *this->ioStream.Handle(), buffer };
+        }
+
+        [[nodiscard]] __impl::FlushOperation
+        AsyncFlush() {
+            return { *this->lpScheduler, *this->ioStream.Handle() };
+        }
+
+        // appends at least one more byte to the buffered input, see
+        // BufferedNetworkStream::Receive
+        [[nodiscard]] __impl::ReceiveOperation
+        AsyncReceive() {
+            return { *this->lpScheduler, *this->ioStream.Handle() };
+        }
+
+        IONetworkStream&
+        Stream() noexcept {
+            return this->ioStream;
+        }
+
+        NetworkScheduler&
+        Scheduler() const noexcept {
+            return *this->lpScheduler;
+        }
+
+    private:
+        NetworkScheduler*
+            lpScheduler = nullptr;
+        IONetworkStream
+            ioStream;
+    };
+
+    namespace __impl {
+        template<typename AddressT>
+        class AcceptOperation final :
+            public PendingOperation {
+        public:
+            using ConnectionType    =
+                std::optional<std::pair<AsyncNetworkStream, AddressT>>;
+
+            AcceptOperation(NetworkScheduler& scheduler, BasicServer<AddressT, IONetworkStream>& server) noexcept :
+                PendingOperation(scheduler, server.Descriptor(), false),
+                refServer(server) {}
+
+            bool
+            Attempt() override {
+                for (;;) {
+                    this->optConnection = this->refServer.Accept();
+                    if (this->optConnection)
+                        return true;
+                    if (AcceptRetryable(errno))
+                        continue;
+
+                    // the listening socket stays readable while the backlog
+                    // is full, so exhaustion would just spin on readiness
+                    this->bStarved  = AcceptExhausted(errno);
+                    return !this->bStarved && errno != EAGAIN && errno != EWOULDBLOCK;
+                }
+            }
+
+            ConnectionType
+            await_resume() {
+                ConnectionType
+                    connection  = std::nullopt;
+                if (this->optConnection) {
+                    connection.emplace(
+                        std::piecewise_construct,
+                        std::forward_as_tuple(this->refScheduler, std::move(this->optConnection->first)),
+                        std::forward_as_tuple(this->optConnection->second));
+                }
+
+                return connection;
+            }
+
+        private:
+            BasicServer<AddressT, IONetworkStream>&
+                refServer;
+            typename BasicServer<AddressT, IONetworkStream>::ConnectionType
+                optConnection;
+        };
+
+        template<typename AddressT>
+        class ConnectOperation final :
+            public PendingOperation {
+        public:
+            ConnectOperation(NetworkScheduler& scheduler, const AddressT& addr, const NetworkBuffers& buffers) noexcept :
+                PendingOperation(scheduler, -1, true),
+                addr(addr),
+                buffers(buffers) {}
+
+            ~ConnectOperation() noexcept {
+                // abandoned halfway, the socket is still ours
+                if (this->fd >= 0) {
+                    this->refScheduler.Forget(this->fd);
+                    close(this->fd);
+                }
+            }
+
+            bool
+            Attempt() noexcept override {
+                if (!this->bStarted) {
+                    this->bStarted  = true;
+                    this->fd        = socket(AddressT::AddressFamily, SOCK_STREAM | SOCK_NONBLOCK, 0);
+                    if (this->fd < 0 || this->addr.Connect(this->fd))
+                        return true;
+                    if (errno == EINPROGRESS)
+                        return false;
+
+                    this->Abandon();
+                    return true;
+                }
+
+                // writable means the handshake is over, one way or the other
+                int
+                    iError  = 0;
+                socklen_t
+                    uLength = sizeof(iError);
+                if (getsockopt(this->fd, SOL_SOCKET, SO_ERROR, &iError, &uLength) != 0 || iError != 0)
+                    this->Abandon();
+                return true;
+            }
+
+            std::optional<AsyncNetworkStream>
+            await_resume() {
+                std::optional<AsyncNetworkStream>
+                    connection  = std::nullopt;
+                if (this->fd >= 0) {
+                    connection.emplace(
+                        this->refScheduler,
+                        IONetworkStream(std::exchange(this->fd, -1), this->buffers));
+                }
+
+                return connection;
+            }
+
+        private:
+            void
+            Abandon() noexcept {
+                close(this->fd);
+                this->fd    = -1;
+            }
+
+            AddressT
+                addr;
+            NetworkBuffers
+                buffers;
+            bool
+                bStarted    = false;
+        };
+
+        // ScanInput for coroutines: waits for more input where the socket
+        // runs dry. false when input ends before the scan is done
+        template<typename FnScan>
+        Task<bool>
+        AsyncScanInput(AsyncNetworkStream& is, FnScan fnScan) {
+            IONetworkStream&
+                stream  = is.Stream();
+            for (;;) {
+                std::span<const std::byte>
+                    window  = stream.BorrowRead();
+                if (!window.empty()) {
+                    ScanStep
+                        step    = fnScan(window);
+                    stream.Consume(step.uConsumed);
+                    if (step.bDone)
+                        co_return true;
+                    continue;
+                }
+
+                std::optional<std::byte>
+                    optc    = stream.Read();
+                if (!optc) {
+                    if (!stream.Handle()->WouldBlock() || !co_await is.AsyncReceive())
+                        co_return false;
+                    continue;
+                }
+
+                ScanStep
+                    step    = fnScan(std::span<const std::byte>{ &*optc, 1 });
+                if (step.uConsumed == 0)
+                    stream.PutBack(*optc);
+                if (step.bDone)
+                    co_return true;
+            }
+        }
+
+        inline Task<bool>
+        AsyncSkipSpaces(AsyncNetworkStream& is) {
+            return AsyncScanInput(is,
+                [](std::span<const std::byte> window) -> ScanStep {
+                    for (size_t i = 0; i != window.size(); ++i) {
+                        if (!isspace((int)window[i]))
+                            return { i, true };
+                    }
+                    return { window.size(), false };
+                });
+        }
+
+        template<typename FnDelim, typename FnSink>
+        Task<bool>
+        AsyncScanUntil(AsyncNetworkStream& is, FnDelim fnIsDelim, bool bEatDelim, FnSink fnSink) {
+            co_return co_await AsyncScanInput(is,
+                [&](std::span<const std::byte> window) -> ScanStep {
+                    for (size_t i = 0; i != window.size(); ++i) {
+                        if (fnIsDelim((char)window[i])) {
+                            fnSink(window.first(i));
+                            return { bEatDelim ? i + 1 : i, true };
+                        }
+                    }
+                    fnSink(window);
+                    return { window.size(), false };
+                });
+        }
+    }
+
+    template<typename AddressT>
+    class AsyncNetworkServer {
+    public:
+        using AddressType       =
+            AddressT;
+        using ConnectionType    =
+            typename __impl::AcceptOperation<AddressT>::ConnectionType;
+
+        AsyncNetworkServer(
+            NetworkScheduler&       scheduler,
+            const AddressT&         addr,
+            int                     iPendingConnections = 1024,
+            const NetworkBuffers&   buffers             = {}) :
+            refScheduler(scheduler),
+            server(addr, iPendingConnections, buffers)
+        {
+            if (!__impl::SetNonBlocking(this->server.Descriptor()))
+                throw std::runtime_error("failed to switch the server socket to non-blocking mode");
+        }
+
+        AsyncNetworkServer(const AsyncNetworkServer&) = delete;
+        AsyncNetworkServer&
+        operator=(const AsyncNetworkServer&) = delete;
+
+        ~AsyncNetworkServer() noexcept {
+            this->refScheduler.Forget(this->server.Descriptor());
+        }
+
+        // resumes with the next connection, or nullopt if accepting failed.
+        // running out of descriptors only delays it until one is released
+        [[nodiscard]] __impl::AcceptOperation<AddressT>
+        AsyncAccept() {
+            return { this->refScheduler, this->server };
+        }
+
+    private:
+        NetworkScheduler&
+            refScheduler;
+        __impl::BasicServer<AddressT, IONetworkStream>
+            server;
+    };
+
+    // every AsyncConnect opens a connection of its own
+    template<typename AddressT>
+    class AsyncNetworkClient {
+    public:
+        using AddressType       =
+            AddressT;
+        using ConnectionType    =
+            std::optional<AsyncNetworkStream>;
+
+        AsyncNetworkClient(NetworkScheduler& scheduler, const NetworkBuffers& buffers = {}) :
+            refScheduler(scheduler),
+            buffers(buffers) {}
+
+        [[nodiscard]] __impl::ConnectOperation<AddressT>
+        AsyncConnect(const AddressT& addr) {
+            return { this->refScheduler, addr, this->buffers };
+        }
+
+    private:
+        NetworkScheduler&
+            refScheduler;
+        NetworkBuffers
+            buffers;
+    };
+
+    // the coroutine counterpart of SerialTextInput: each getter resumes
+    // with false when input ended before anything could be read
+    class AsyncTextInput {
+    public:
+        AsyncTextInput(const AsyncTextInput&) = delete;
+
+        AsyncTextInput(AsyncNetworkStream& is) :
+            refStream(is) {}
+
+        auto&
+        stream() const noexcept {
+            return this->refStream;
+        }
+
+        Task<bool>
+        get_char(char& out) const {
+            IONetworkStream&
+                stream  = this->refStream.Stream();
+            for (;;) {
+                std::optional<std::byte>
+                    optc    = stream.Read();
+                if (optc) {
+                    out = (char)*optc;
+                    co_return true;
+                }
+
+                if (!stream.Handle()->WouldBlock() || !co_await this->refStream.AsyncReceive())
+                    co_return false;
+            }
+        }
+
+        Task<bool>
+        get_word(std::string& out) const {
+            std::string
+                strWord;
+            co_await __impl::AsyncSkipSpaces(this->refStream);
+            co_await __impl::AsyncScanUntil(this->refStream,
+                [](char c) { return isspace((int)c) != 0; }, false,
+                [&](std::span<const std::byte> bytes) {
+                    strWord.append((const char*)bytes.data(), bytes.size());
+                });
+
+            out = std::move(strWord);
+            co_return !out.empty();
+        }
+
+        Task<bool>
+        get_line(std::string& out) const {
+            std::string
+                strLine;
+            bool
+                bFound  = co_await __impl::AsyncScanUntil(this->refStream,
+                            [](char c) { return c == '\n'; }, true,
+                            [&](std::span<const std::byte> bytes) {
+                                strLine.append((const char*)bytes.data(), bytes.size());
+                            });
+
+            out = std::move(strLine);
+            co_return bFound || !out.empty();
+        }
+
+        // true when the peer closed its side rather than the socket failing
+        Task<bool>
+        get_all(std::string& out) const {
+            std::string
+                strAll;
+            co_await __impl::AsyncScanUntil(this->refStream,
+                [](char) { return false; }, false,
+                [&](std::span<const std::byte> bytes) {
+                    strAll.append((const char*)bytes.data(), bytes.size());
+                });
+
+            out = std::move(strAll);
+            co_return this->refStream.Stream().EndOfStream();
+        }
+
+        // numbers are read as a whole word, which must parse completely
+        Task<bool>
+        get_int(std::integral auto& out, int base = 10) const {
+            std::string
+                strWord;
+            if (!co_await this->get_word(strWord))
+                co_return false;
+
+            std::from_chars_result
+                result  = std::from_chars(strWord.data(), strWord.data() + strWord.size(), out, base);
+            co_return result.ec == std::errc() && result.ptr == strWord.data() + strWord.size();
+        }
+
+        Task<bool>
+        get_float(std::floating_point auto& out) const {
+            std::string
+                strWord;
+            if (!co_await this->get_word(strWord))
+                co_return false;
+
+            std::from_chars_result
+                result  = std::from_chars(strWord.data(), strWord.data() + strWord.size(), out);
+            co_return result.ec == std::errc() && result.ptr == strWord.data() + strWord.size();
+        }
+
+    private:
+        AsyncNetworkStream&
+            refStream;
+    };
+
+    // the coroutine counterpart of SerialBinaryInput; getters resume with
+    // false when input ended before the value was complete
+    class AsyncBinaryInput {
+    public:
+        AsyncBinaryInput(const AsyncBinaryInput&) = delete;
+
+        AsyncBinaryInput(AsyncNetworkStream& is) :
+            refStream(is) {}
+
+        auto&
+        stream() const noexcept {
+            return this->refStream;
+        }
+
+        Task<bool>
+        get_data(std::span<std::byte> buffer) const {
+            size_t
+                uRead   = 0;
+            while (uRead != buffer.size()) {
+                size_t
+                    uCount  = co_await this->refStream.AsyncReadSome(buffer.subspan(uRead));
+                if (uCount == 0)
+                    co_return false;
+                uRead   += uCount;
+            }
+
+            co_return true;
+        }
+
+        Task<bool>
+        get_int(std::integral auto& value) const {
+            return this->get_data({ (std::byte*)&value, sizeof(value) });
+        }
+
+        Task<bool>
+        get_float(std::floating_point auto& value) const {
+            return this->get_data({ (std::byte*)&value, sizeof(value) });
+        }
+
+    private:
+        AsyncNetworkStream&
+            refStream;
+    };
+}
@@ -0,0 +1,132 @@
+#pragma once
+#include <cerrno>
+#include <cstdint>
+#include <cstddef>
+#include <span>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+
+namespace io {
+    enum class AccessHint {
+        Normal      = 0,
+        Sequential  = 1,
+        Random      = 2,
+        WillNeed    = 3,    // start reading the range into the page cache
+        DontNeed    = 4     // evict the range from the page cache
+    };
+
+    namespace __impl {
+        inline bool
+        AdviseDescriptor(int fd, AccessHint hint, uint64_t uOffset, uint64_t uLength) noexcept {
+#if defined(POSIX_FADV_NORMAL)
+            int iAdvice = POSIX_FADV_NORMAL;
+            switch (hint) {
+            case AccessHint::Normal:
+                iAdvice = POSIX_FADV_NORMAL;
+                break;
+
+            case AccessHint::Sequential:
+                iAdvice = POSIX_FADV_SEQUENTIAL;
+                break;
+
+            case AccessHint::Random:
+                iAdvice = POSIX_FADV_RANDOM;
+                break;
+
+            case AccessHint::WillNeed:
+                iAdvice = POSIX_FADV_WILLNEED;
+                break;
+
+            case AccessHint::DontNeed:
+                iAdvice = POSIX_FADV_DONTNEED;
+                break;
+            }
+
+            return posix_fadvise(fd, (off_t)uOffset, (off_t)uLength, iAdvice) == 0;
+#else
+            (void)fd; (void)hint; (void)uOffset; (void)uLength;
+            return false;
+#endif
+        }
+
+        // evicts what a sequential reader has already consumed, in steps of
+        // uWindow bytes, so one pass over a huge file keeps the cache intact
+        struct DropBehind {
+            void
+            Advance(int fd, uint64_t uConsumed) noexcept {
+                if (this->uWindow == 0)
+                    return;
+
+                if (uConsumed < this->uDropped) {
+                    this->uDropped  = uConsumed;
+                } else if (uConsumed - this->uDropped >= this->uWindow) {
+                    AdviseDescriptor(fd, AccessHint::DontNeed, this->uDropped, uConsumed - this->uDropped);
+                    this->uDropped  = uConsumed;
+                }
+            }
+
+            uint64_t
+                uWindow     = 0,
+                uDropped    = 0;
+        };
+
+        // moves a (span, offset) cursor over a list of spans by uCount bytes,
+        // for vectored calls that took only part of them
+        template<typename SpanT>
+        void
+        AdvanceCursor(std::span<const SpanT> buffers, size_t& uIndex, size_t& uOffset, size_t uCount) noexcept {
+            while (uIndex != buffers.size()) {
+                size_t
+                    uLeft   = buffers[uIndex].size() - uOffset;
+                if (uCount < uLeft) {
+                    uOffset += uCount;
+                    return;
+                }
+
+                uCount  -= uLeft;
+                uIndex  += 1;
+                uOffset = 0;
+            }
+        }
+
+        inline size_t
+        PositionalRead(int fd, uint64_t uOffset, std::span<std::byte> buffer) noexcept {
+            size_t
+                uRead   = 0;
+            while (uRead != buffer.size()) {
+                ssize_t
+                    iResult = pread(fd,
+                        buffer.data() + uRead, buffer.size() - uRead,
+                        (off_t)(uOffset + uRead));
+                if (iResult < 0 && errno == EINTR)
+                    continue;
+                if (iResult <= 0)
+                    break;
+                uRead   += (size_t)iResult;
+            }
+
+            return uRead;
+        }
+
+        inline size_t
+        PositionalWrite(int fd, uint64_t uOffset, std::span<const std::byte> buffer) noexcept {
+            size_t
+                uWritten    = 0;
+            while (uWritten != buffer.size()) {
+                ssize_t
+                    iResult = pwrite(fd,
+                        buffer.data() + uWritten, buffer.size() - uWritten,
+                        (off_t)(uOffset + uWritten));
+                if (iResult < 0 && errno == EINTR)
+                    continue;
+                if (iResult <= 0)
+                    break;
+                uWritten    += (size_t)iResult;
+            }
+
+            return uWritten;
+        }
+    }
+}
@@ -0,0 +1,583 @@
+#pragma once
+#include <cerrno>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <format>
+#include <memory>
+#include <string>
+#include <algorithm>
+#include <stdexcept>
+#include <string_view>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#include "IOStreams.hpp"
+#include "FdStreams.hpp"
+
+
+namespace io {
+    namespace __impl {
+        class DirectFileBase :
+            virtual public  StreamState,
+            virtual public  StreamPosition {
+        public:
+            static constexpr size_t
+                uDefaultBufferSize  = 1024 * 1024,
+                uMinAlignment       = 4096;
+
+            DirectFileBase(std::string_view strvFilename, int iFlags, size_t uBufferSize) :
+                lpBuffer(nullptr)
+            {
+                std::string
+                    strFilename(strvFilename);
+#if defined(O_DIRECT)
+                this->fd        = open(strFilename.c_str(), iFlags | O_DIRECT | O_CLOEXEC, 0666);
+                this->bDirect   = this->fd >= 0;
+                if (this->fd < 0 && errno == EINVAL)
+                    this->fd    = open(strFilename.c_str(), iFlags | O_CLOEXEC, 0666);
+#else
+                this->fd        = open(strFilename.c_str(), iFlags | O_CLOEXEC, 0666);
+#endif
+
+                if (this->fd < 0) {
+                    throw std::runtime_error(std::format(
+                        "failed to open file {}: {}",
+                        strvFilename, strerror(errno)));
+                }
+
+                // positional access has no alignment guarantees, so it goes
+                // through a second, page-cached descriptor
+                this->fdPositional  = this->fd;
+                if (this->bDirect) {
+                    int fdBuffered  = open(strFilename.c_str(), (iFlags & O_ACCMODE) | O_CLOEXEC);
+                    if (fdBuffered >= 0)
+                        this->fdPositional  = fdBuffered;
+                }
+
+                struct stat
+                    st;
+                this->uAlign    = uMinAlignment;
+                if (fstat(this->fd, &st) == 0)
+                    this->uAlign    = std::max(this->uAlign, (size_t)st.st_blksize);
+
+                this->uBufferSize   = std::max(
+                    (uBufferSize + this->uAlign - 1) / this->uAlign * this->uAlign,
+                    this->uAlign);
+                this->lpBuffer.reset((std::byte*)aligned_alloc(this->uAlign, this->uBufferSize));
+                if (this->lpBuffer == nullptr) {
+                    if (this->fdPositional != this->fd)
+                        close(this->fdPositional);
+                    close(this->fd);
+                    throw std::runtime_error("failed to allocate an aligned buffer");
+                }
+            }
+
+            DirectFileBase(const DirectFileBase&) = delete;
+            DirectFileBase&
+            operator=(const DirectFileBase&) = delete;
+
+            ~DirectFileBase() noexcept {
+                if (this->fdPositional != this->fd)
+                    close(this->fdPositional);
+                close(this->fd);
+            }
+
+            [[nodiscard]] bool
+            EndOfStream() const noexcept override {
+                return this->bEOF;
+            }
+
+            [[nodiscard]] bool
+            Good() const noexcept override {
+                return !this->bErr;
+            }
+
+            void
+            ClearFlags() noexcept override {
+                this->bEOF  = false;
+                this->bErr  = false;
+            }
+
+            [[nodiscard]] int
+            Descriptor() const noexcept {
+                return this->fd;
+            }
+
+            [[nodiscard]] bool
+            IsDirect() const noexcept {
+                return this->bDirect;
+            }
+
+            [[nodiscard]] size_t
+            Alignment() const noexcept {
+                return this->uAlign;
+            }
+
+        protected:
+            struct AlignedDelete {
+                void
+                operator()(std::byte* lpData) const noexcept {
+                    free(lpData);
+                }
+            };
+
+            size_t
+            ReadBlock(uint64_t uOffset, size_t uSize) {
+                size_t
+                    uRead   = 0;
+                while (uRead != uSize) {
+                    ssize_t
+                        iResult = pread(this->fd,
+                            this->lpBuffer.get() + uRead, uSize - uRead,
+                            (off_t)(uOffset + uRead));
+                    if (iResult < 0 && errno == EINTR)
+                        continue;
+                    if (iResult < 0)
+                        this->bErr  = true;
+                    if (iResult <= 0)
+                        break;
+
+                    uRead   += (size_t)iResult;
+                    if (uRead % this->uAlign != 0)
+                        break;
+                }
+
+                return uRead;
+            }
+
+            bool
+            WriteBlock(uint64_t uOffset, size_t uSize) {
+                size_t
+                    uWritten    = 0;
+                while (uWritten != uSize) {
+                    ssize_t
+                        iResult = pwrite(this->fd,
+                            this->lpBuffer.get() + uWritten, uSize - uWritten,
+                            (off_t)(uOffset + uWritten));
+                    if (iResult < 0 && errno == EINTR)
+                        continue;
+                    if (iResult <= 0) {
+                        this->bErr  = true;
+                        return false;
+                    }
+                    uWritten    += (size_t)iResult;
+                }
+
+                return true;
+            }
+
+            bool
+            WriteTail(uint64_t uOffset, size_t uSize) {
+#if defined(O_DIRECT)
+                if (!this->bDirect)
+                    return this->WriteBlock(uOffset, uSize);
+
+                int iFlags  = fcntl(this->fd, F_GETFL);
+                if (iFlags < 0 || fcntl(this->fd, F_SETFL, iFlags & ~O_DIRECT) != 0) {
+                    this->bErr  = true;
+                    return false;
+                }
+
+                bool bResult    = this->WriteBlock(uOffset, uSize);
+                if (fcntl(this->fd, F_SETFL, iFlags) != 0)
+                    this->bErr  = true;
+                return bResult && !this->bErr;
+#else
+                return this->WriteBlock(uOffset, uSize);
+#endif
+            }
+
+            [[nodiscard]] std::optional<uint64_t>
+            FileSize() const noexcept {
+                struct stat
+                    st;
+                if (fstat(this->fd, &st) != 0)
+                    return std::nullopt;
+                return (uint64_t)st.st_size;
+            }
+
+            std::optional<uint64_t>
+            ResolveOffset(intptr_t offset, StreamOffsetOrigin from, uint64_t uCurrent) const noexcept {
+                switch (from) {
+                case StreamOffsetOrigin::CurrentPos:
+                    offset  += (intptr_t)uCurrent;
+                    break;
+
+                case StreamOffsetOrigin::StreamStart:
+                    offset  += 0;
+                    break;
+
+                case StreamOffsetOrigin::StreamEnd: {
+                    std::optional<uint64_t>
+                        optSize = this->FileSize();
+                    if (!optSize)
+                        return std::nullopt;
+                    offset  += (intptr_t)*optSize;
+                    break;
+                }
+                }
+
+                if (offset < 0)
+                    return std::nullopt;
+                return (uint64_t)offset;
+            }
+
+            int
+                fd              = -1,
+                fdPositional    = -1;
+            std::unique_ptr<std::byte[], AlignedDelete>
+                lpBuffer;
+            size_t
+                uAlign      = 0,
+                uBufferSize = 0;
+            bool
+                bDirect     = false,
+                bEOF        = false,
+                bErr        = false;
+        };
+
+        class DirectIFileBase :
+            public DirectFileBase {
+        public:
+            DirectIFileBase(std::string_view strvFilename, size_t uBufferSize) :
+                DirectFileBase(strvFilename, O_RDONLY, uBufferSize) {}
+
+            bool
+            Flush() noexcept override {
+                return !this->bErr;
+            }
+
+            [[nodiscard]] intptr_t
+            GetPosition() const noexcept override {
+                return (intptr_t)(this->uOffset + this->uBegin);
+            }
+
+            bool
+            SetPosition(
+                intptr_t            offset,
+                StreamOffsetOrigin  from = StreamOffsetOrigin::StreamStart) override
+            {
+                std::optional<uint64_t>
+                    optTarget   = this->ResolveOffset(offset, from, this->uOffset + this->uBegin);
+                if (!optTarget)
+                    return false;
+
+                if (*optTarget >= this->uOffset && *optTarget <= this->uOffset + this->uEnd) {
+                    this->uBegin    = (size_t)(*optTarget - this->uOffset);
+                } else {
+                    this->uOffset   = *optTarget / this->uAlign * this->uAlign;
+                    this->uBegin    = (size_t)(*optTarget - this->uOffset);
+                    this->uEnd      = this->uBegin;
+                    this->bSkip     = true;
+                }
+
+                this->bEOF  = false;
+                return true;
+            }
+
+        protected:
+            std::optional<std::byte>
+            Read() {
+                if (this->uBegin >= this->uEnd && !this->Fill())
+                    return std::nullopt;
+
+                return this->lpBuffer[this->uBegin++];
+            }
+
+            size_t
+            ReadSome(std::span<std::byte> buffer) {
+                size_t
+                    uRead   = 0;
+                while (uRead != buffer.size()) {
+                    if (this->uBegin >= this->uEnd && !this->Fill())
+                        break;
+
+                    size_t
+                        uCount  = std::min(buffer.size() - uRead, this->uEnd - this->uBegin);
+                    memcpy(buffer.data() + uRead, this->lpBuffer.get() + this->uBegin, uCount);
+                    this->uBegin    += uCount;
+                    uRead           += uCount;
+                }
+
+                return uRead;
+            }
+
+            bool
+            PutBack(std::byte c) {
+                if (this->uBegin == 0 || this->uBegin > this->uEnd)
+                    return false;
+
+                this->lpBuffer[--this->uBegin] = c;
+                this->bEOF  = false;
+                return true;
+            }
+
+            std::span<const std::byte>
+            BorrowRead() {
+                if (this->uBegin >= this->uEnd && !this->Fill())
+                    return {};
+
+                return { this->lpBuffer.get() + this->uBegin, this->uEnd - this->uBegin };
+            }
+
+            void
+            Consume(size_t uCount) {
+                this->uBegin    += uCount;
+            }
+
+            size_t
+            ReadAt(uint64_t uOffset, std::span<std::byte> buffer) {
+                return PositionalRead(this->fdPositional, uOffset, buffer);
+            }
+
+        private:
+            bool
+            Fill() {
+                size_t
+                    uSkip   = 0;
+                if (this->bSkip) {
+                    uSkip   = this->uBegin;
+                } else {
+                    this->uOffset   += this->uEnd;
+                    if (this->uOffset % this->uAlign != 0) {
+                        uSkip           = (size_t)(this->uOffset % this->uAlign);
+                        this->uOffset   -= uSkip;
+                    }
+                }
+
+                this->bSkip     = false;
+                this->uEnd      = this->ReadBlock(this->uOffset, this->uBufferSize);
+                this->uBegin    = uSkip;
+                if (this->uBegin >= this->uEnd) {
+                    this->uBegin    = std::min(this->uBegin, this->uEnd);
+                    if (!this->bErr)
+                        this->bEOF  = true;
+                    return false;
+                }
+
+                return true;
+            }
+
+            uint64_t
+                uOffset = 0;
+            size_t
+                uBegin  = 0,
+                uEnd    = 0;
+            bool
+                bSkip   = false;
+        };
+
+        class DirectOFileBase :
+            public DirectFileBase {
+        public:
+            DirectOFileBase(std::string_view strvFilename, int iFlags, size_t uBufferSize) :
+                DirectFileBase(strvFilename, (iFlags & ~O_ACCMODE) | O_RDWR, uBufferSize) {}
+
+            ~DirectOFileBase() noexcept {
+                this->Flush();
+            }
+
+            bool
+            Flush() noexcept override {
+                if (this->uFill == 0)
+                    return !this->bErr;
+
+                size_t
+                    uAligned    = this->uFill / this->uAlign * this->uAlign;
+                if (uAligned != 0) {
+                    if (!this->WriteBlock(this->uOffset, uAligned))
+                        return false;
+
+                    memmove(this->lpBuffer.get(), this->lpBuffer.get() + uAligned, this->uFill - uAligned);
+                    this->uOffset   += uAligned;
+                    this->uFill     -= uAligned;
+                }
+
+                if (this->uFill != 0)
+                    return this->WriteTail(this->uOffset, this->uFill);
+                return !this->bErr;
+            }
+
+            [[nodiscard]] intptr_t
+            GetPosition() const noexcept override {
+                return (intptr_t)(this->uOffset + this->uFill);
+            }
+
+            bool
+            SetPosition(
+                intptr_t            offset,
+                StreamOffsetOrigin  from = StreamOffsetOrigin::StreamStart) override
+            {
+                if (!this->Flush())
+                    return false;
+
+                std::optional<uint64_t>
+                    optTarget   = this->ResolveOffset(offset, from, this->uOffset + this->uFill);
+                if (!optTarget)
+                    return false;
+
+                this->uOffset   = *optTarget / this->uAlign * this->uAlign;
+                this->uFill     = (size_t)(*optTarget - this->uOffset);
+                if (this->uFill != 0) {
+                    size_t
+                        uRead   = this->ReadBlock(this->uOffset, this->uAlign);
+                    if (uRead < this->uFill)
+                        memset(this->lpBuffer.get() + uRead, 0, this->uFill - uRead);
+                }
+
+                return !this->bErr;
+            }
+
+        protected:
+            bool
+            Write(std::byte c) {
+                if (this->uFill == this->uBufferSize && !this->FlushFull())
+                    return false;
+
+                this->lpBuffer[this->uFill++] = c;
+                return true;
+            }
+
+            size_t
+            WriteSome(std::span<const std::byte> buffer) {
+                size_t
+                    uWritten    = 0;
+                while (uWritten != buffer.size()) {
+                    if (this->uFill == this->uBufferSize && !this->FlushFull())
+                        break;
+
+                    size_t
+                        uCount  = std::min(buffer.size() - uWritten, this->uBufferSize - this->uFill);
+                    memcpy(this->lpBuffer.get() + this->uFill, buffer.data() + uWritten, uCount);
+                    this->uFill += uCount;
+                    uWritten    += uCount;
+                }
+
+                return uWritten;
+            }
+
+            std::span<std::byte>
+            BorrowWrite(size_t uMinSize) {
+                if (this->uBufferSize - this->uFill < uMinSize && !this->FlushFull())
+                    return {};
+                if (this->uBufferSize - this->uFill < std::max<size_t>(uMinSize, 1))
+                    return {};
+
+                return { this->lpBuffer.get() + this->uFill, this->uBufferSize - this->uFill };
+            }
+
+            void
+            Commit(size_t uCount) {
+                this->uFill += uCount;
+            }
+
+            size_t
+            WriteAt(uint64_t uOffset, std::span<const std::byte> buffer) {
+                if (!this->Flush())
+                    return 0;
+
+                size_t
+                    uWritten    = PositionalWrite(this->fdPositional, uOffset, buffer);
+                if (uWritten != buffer.size())
+                    this->bErr  = true;
+                return uWritten;
+            }
+
+        private:
+            bool
+            FlushFull() {
+                size_t
+                    uAligned    = this->uFill / this->uAlign * this->uAlign;
+                if (uAligned == 0 || !this->WriteBlock(this->uOffset, uAligned))
+                    return false;
+
+                memmove(this->lpBuffer.get(), this->lpBuffer.get() + uAligned, this->uFill - uAligned);
+                this->uOffset   += uAligned;
+                this->uFill     -= uAligned;
+                return true;
+            }
+
+            uint64_t
+                uOffset = 0;
+            size_t
+                uFill   = 0;
+        };
+    }
+
+    class DirectIFileStream final :
+        public  IStream,
+        public  __impl::DirectIFileBase {
+    public:
+        DirectIFileStream(std::string_view strvFilename, size_t uBufferSize = uDefaultBufferSize) :
+            DirectIFileBase(strvFilename, uBufferSize) {}
+
+        std::optional<std::byte>
+        Read() override {
+            return this->DirectIFileBase::Read();
+        }
+
+        size_t
+        ReadSome(std::span<std::byte> buffer) override {
+            return this->DirectIFileBase::ReadSome(buffer);
+        }
+
+        bool
+        PutBack(std::byte c) override {
+            return this->DirectIFileBase::PutBack(c);
+        }
+
+        std::span<const std::byte>
+        BorrowRead() override {
+            return this->DirectIFileBase::BorrowRead();
+        }
+
+        void
+        Consume(size_t uCount) override {
+            this->DirectIFileBase::Consume(uCount);
+        }
+
+        size_t
+        ReadAt(uint64_t uOffset, std::span<std::byte> buffer) override {
+            return this->DirectIFileBase::ReadAt(uOffset, buffer);
+        }
+    };
+
+    class DirectOFileStream final :
+        public  OStream,
+        public  __impl::DirectOFileBase {
+    public:
+        DirectOFileStream(
+            std::string_view    strvFilename,
+            size_t              uBufferSize = uDefaultBufferSize,
+            int                 iFlags      = O_WRONLY | O_CREAT | O_TRUNC) :
+            DirectOFileBase(strvFilename, iFlags, uBufferSize) {}
+
+        bool
+        Write(std::byte c) override {
+            return this->DirectOFileBase::Write(c);
+        }
+
+        size_t
+        WriteSome(std::span<const std::byte> buffer) override {
+            return this->DirectOFileBase::WriteSome(buffer);
+        }
+
+        std::span<std::byte>
+        BorrowWrite(size_t uMinSize) override {
+            return this->DirectOFileBase::BorrowWrite(uMinSize);
+        }
+
+        void
+        Commit(size_t uCount) override {
+            this->DirectOFileBase::Commit(uCount);
+        }
+
+        size_t
+        WriteAt(uint64_t uOffset, std::span<const std::byte> buffer) override {
+            return this->DirectOFileBase::WriteAt(uOffset, buffer);
+        }
+    };
+}
@@ -0,0 +1,908 @@
+#pragma once
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <format>
+#include <memory>
+#include <string>
+#include <algorithm>
+#include <stdexcept>
+#include <string_view>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/uio.h>
+
+#include "IOStreams.hpp"
+#include "DescriptorIO.hpp"
+
+
+namespace io {
+    namespace __impl {
+        class FdStreamViewBase :
+            virtual public  StreamState,
+            virtual public  StreamPosition {
+        public:
+            static constexpr size_t
+                uDefaultBufferSize  = 64 * 1024;
+
+            FdStreamViewBase(int fd, size_t uBufferSize = uDefaultBufferSize) :
+                fd(fd),
+                lpBuffer(new std::byte[std::max<size_t>(uBufferSize, 1)]),
+                uBufferSize(std::max<size_t>(uBufferSize, 1)) {}
+
+            FdStreamViewBase(const FdStreamViewBase&) = delete;
+            FdStreamViewBase(FdStreamViewBase&& obj) noexcept :
+                fd(obj.fd),
+                lpBuffer(std::move(obj.lpBuffer)),
+                uBufferSize(obj.uBufferSize),
+                uBegin(obj.uBegin),
+                uEnd(obj.uEnd),
+                uWritten(obj.uWritten),
+                dropBehind(obj.dropBehind),
+                bEOF(obj.bEOF),
+                bErr(obj.bErr)
+            {
+                obj.fd          = -1;
+                obj.uBegin      = 0;
+                obj.uEnd        = 0;
+                obj.uWritten    = 0;
+            }
+
+            FdStreamViewBase&
+            operator=(const FdStreamViewBase&) = delete;
+
+            ~FdStreamViewBase() noexcept {
+                if (this->fd != -1)
+                    this->FlushWrite();
+            }
+
+            [[nodiscard]] bool
+            EndOfStream() const noexcept override {
+                return this->bEOF;
+            }
+
+            [[nodiscard]] bool
+            Good() const noexcept override {
+                return !this->bErr;
+            }
+
+            void
+            ClearFlags() noexcept override {
+                this->bEOF  = false;
+                this->bErr  = false;
+            }
+
+            bool
+            Flush() noexcept override {
+                return this->FlushWrite();
+            }
+
+            [[nodiscard]] int
+            Descriptor() const noexcept {
+                return this->fd;
+            }
+
+            [[nodiscard]] size_t
+            BufferSize() const noexcept {
+                return this->uBufferSize;
+            }
+
+            [[nodiscard]] int
+            TransferDescriptor() const noexcept override {
+                if (this->uBegin != this->uEnd || this->uWritten != 0)
+                    return -1;
+                return this->fd;
+            }
+
+            int
+            SyncDescriptor() noexcept override {
+                if (!this->FlushWrite())
+                    return -1;
+                return this->fd;
+            }
+
+            bool
+            Advise(AccessHint hint, uint64_t uOffset = 0, uint64_t uLength = 0) noexcept {
+                return AdviseDescriptor(this->fd, hint, uOffset, uLength);
+            }
+
+            // 0 turns dropping off
+            void
+            SetDropBehind(uint64_t uWindow) noexcept {
+                this->dropBehind.uWindow    = uWindow;
+            }
+
+            [[nodiscard]] intptr_t
+            GetPosition() const noexcept override {
+                off_t
+                    offset  = lseek(this->fd, 0, SEEK_CUR);
+                if (offset < 0)
+                    return -1;
+
+                return (intptr_t)(offset - (off_t)(this->uEnd - this->uBegin) + (off_t)this->uWritten);
+            }
+
+            bool
+            SetPosition(
+                intptr_t            offset,
+                StreamOffsetOrigin  from = StreamOffsetOrigin::StreamStart) override
+            {
+                if (!this->FlushWrite())
+                    return false;
+
+                if (from == StreamOffsetOrigin::CurrentPos)
+                    offset  -= (intptr_t)(this->uEnd - this->uBegin);
+
+                if (lseek(this->fd, (off_t)offset, (int)from) < 0)
+                    return false;
+
+                this->uBegin    = 0;
+                this->uEnd      = 0;
+                this->bEOF      = false;
+                return true;
+            }
+
+        protected:
+            size_t
+            ReadAt(uint64_t uOffset, std::span<std::byte> buffer) {
+                if (!this->FlushWrite())
+                    return 0;
+
+                return PositionalRead(this->fd, uOffset, buffer);
+            }
+
+            // read-ahead covering the range would turn stale, so it goes
+            size_t
+            WriteAt(uint64_t uOffset, std::span<const std::byte> buffer) {
+                if (!this->FlushWrite() || !this->DropRead())
+                    return 0;
+
+                size_t
+                    uWritten    = PositionalWrite(this->fd, uOffset, buffer);
+                if (uWritten != buffer.size())
+                    this->bErr  = true;
+                return uWritten;
+            }
+
+            std::optional<std::byte>
+            Read() {
+                if (this->uBegin == this->uEnd && !this->Fill())
+                    return std::nullopt;
+
+                return this->lpBuffer[this->uBegin++];
+            }
+
+            size_t
+            ReadSome(std::span<std::byte> buffer) {
+                size_t
+                    uRead   = 0;
+                while (uRead != buffer.size()) {
+                    if (this->uBegin != this->uEnd) {
+                        size_t
+                            uCount  = std::min(buffer.size() - uRead, this->uEnd - this->uBegin);
+                        memcpy(buffer.data() + uRead, this->lpBuffer.get() + this->uBegin, uCount);
+                        this->uBegin    += uCount;
+                        uRead           += uCount;
+                        continue;
+                    }
+
+                    if (buffer.size() - uRead < this->uBufferSize) {
+                        if (!this->Fill())
+                            break;
+                        continue;
+                    }
+
+                    if (!this->FlushWrite())
+                        break;
+
+                    size_t
+                        uCount  = this->ReadDirect(buffer.subspan(uRead));
+                    if (uCount == 0)
+                        break;
+                    uRead   += uCount;
+                }
+
+                return uRead;
+            }
+
+            // drains the buffer, then one readv per batch straight into the
+            // spans; the last batch reads ahead into the buffer as well
+            size_t
+            ReadSomeV(std::span<const std::span<std::byte>> buffers) {
+                size_t
+                    uTotal  = 0,
+                    uIndex  = 0,
+                    uOffset = 0;
+                while (uIndex != buffers.size() && this->uBegin != this->uEnd) {
+                    std::span<std::byte>
+                        buffer  = buffers[uIndex].subspan(uOffset);
+                    size_t
+                        uCount  = std::min(buffer.size(), this->uEnd - this->uBegin);
+                    if (uCount != 0)
+                        memcpy(buffer.data(), this->lpBuffer.get() + this->uBegin, uCount);
+                    this->uBegin    += uCount;
+                    uTotal          += uCount;
+                    AdvanceCursor(buffers, uIndex, uOffset, uCount);
+                }
+
+                if (uIndex == buffers.size() || !this->FlushWrite())
+                    return uTotal;
+
+                for (;;) {
+                    // empty spans would make readv report an end of file
+                    AdvanceCursor(buffers, uIndex, uOffset, 0);
+                    if (uIndex == buffers.size())
+                        break;
+
+                    struct iovec
+                        lpVec[uMaxVec];
+                    size_t
+                        uVecs   = 0,
+                        uWanted = 0,
+                        j       = uIndex;
+                    for (; j != buffers.size() && uVecs != uMaxVec - 1; ++j) {
+                        std::span<std::byte>
+                            buffer  = buffers[j].subspan((j == uIndex) ? uOffset : 0);
+                        lpVec[uVecs++]  = { buffer.data(), buffer.size() };
+                        uWanted         += buffer.size();
+                    }
+                    // a later readv would land after what's read ahead here
+                    if (j == buffers.size())
+                        lpVec[uVecs++]  = { this->lpBuffer.get(), this->uBufferSize };
+
+                    size_t
+                        uRead   = this->ReadDirectV(lpVec, uVecs);
+                    if (uRead > uWanted) {
+                        this->uBegin    = 0;
+                        this->uEnd      = uRead - uWanted;
+                        uRead           = uWanted;
+                    }
+
+                    uTotal  += uRead;
+                    AdvanceCursor(buffers, uIndex, uOffset, uRead);
+                    if (uRead != uWanted)
+                        break;
+                }
+
+                return uTotal;
+            }
+
+            bool
+            PutBack(std::byte c) {
+                if (this->uWritten != 0)
+                    return false;
+
+                if (this->uBegin == this->uEnd) {
+                    this->uBegin    = this->uBufferSize;
+                    this->uEnd      = this->uBufferSize;
+                }
+                if (this->uBegin == 0)
+                    return false;
+
+                this->lpBuffer[--this->uBegin] = c;
+                this->bEOF  = false;
+                return true;
+            }
+
+            std::span<const std::byte>
+            BorrowRead() {
+                if (this->uBegin == this->uEnd && !this->Fill())
+                    return {};
+
+                return { this->lpBuffer.get() + this->uBegin, this->uEnd - this->uBegin };
+            }
+
+            void
+            Consume(size_t uCount) {
+                this->uBegin    += uCount;
+            }
+
+            bool
+            Write(std::byte c) {
+                if (!this->DropRead())
+                    return false;
+                if (this->uWritten == this->uBufferSize && !this->FlushWrite())
+                    return false;
+
+                this->lpBuffer[this->uWritten++] = c;
+                return true;
+            }
+
+            size_t
+            WriteSome(std::span<const std::byte> buffer) {
+                if (!this->DropRead())
+                    return 0;
+
+                if (buffer.size() <= this->uBufferSize - this->uWritten) {
+                    memcpy(this->lpBuffer.get() + this->uWritten, buffer.data(), buffer.size());
+                    this->uWritten  += buffer.size();
+                    return buffer.size();
+                }
+
+                if (!this->FlushWrite())
+                    return 0;
+
+                if (buffer.size() >= this->uBufferSize)
+                    return this->WriteDirect(buffer);
+
+                memcpy(this->lpBuffer.get(), buffer.data(), buffer.size());
+                this->uWritten  = buffer.size();
+                return buffer.size();
+            }
+
+            // what fits is staged as usual; otherwise the staged bytes and
+            // the spans go out together, one writev per batch
+            size_t
+            WriteSomeV(std::span<const std::span<const std::byte>> buffers) {
+                if (!this->DropRead())
+                    return 0;
+
+                size_t
+                    uTotal  = 0;
+                for (std::span<const std::byte> buffer : buffers)
+                    uTotal  += buffer.size();
+
+                if (uTotal <= this->uBufferSize - this->uWritten) {
+                    for (std::span<const std::byte> buffer : buffers) {
+                        if (!buffer.empty())
+                            memcpy(this->lpBuffer.get() + this->uWritten, buffer.data(), buffer.size());
+                        this->uWritten  += buffer.size();
+                    }
+
+                    return uTotal;
+                }
+
+                size_t
+                    uSent   = 0,
+                    uStaged = 0,
+                    uIndex  = 0,
+                    uOffset = 0;
+                for (;;) {
+                    AdvanceCursor(buffers, uIndex, uOffset, 0);
+                    if (uStaged == this->uWritten && uIndex == buffers.size())
+                        break;
+
+                    struct iovec
+                        lpVec[uMaxVec];
+                    size_t
+                        uVecs   = 0;
+                    if (uStaged != this->uWritten)
+                        lpVec[uVecs++]  = { this->lpBuffer.get() + uStaged, this->uWritten - uStaged };
+                    for (size_t j = uIndex; j != buffers.size() && uVecs != uMaxVec; ++j) {
+                        std::span<const std::byte>
+                            buffer  = buffers[j].subspan((j == uIndex) ? uOffset : 0);
+                        lpVec[uVecs++]  = { (void*)buffer.data(), buffer.size() };
+                    }
+
+                    ssize_t
+                        iResult = writev(this->fd, lpVec, (int)uVecs);
+                    if (iResult < 0 && errno == EINTR)
+                        continue;
+                    if (iResult <= 0) {
+                        this->bErr  = true;
+                        break;
+                    }
+
+                    size_t
+                        uCount      = (size_t)iResult,
+                        uFlushed    = std::min(uCount, this->uWritten - uStaged);
+                    uStaged += uFlushed;
+                    uCount  -= uFlushed;
+                    uSent   += uCount;
+                    AdvanceCursor(buffers, uIndex, uOffset, uCount);
+                }
+
+                if (uStaged != 0) {
+                    memmove(this->lpBuffer.get(), this->lpBuffer.get() + uStaged, this->uWritten - uStaged);
+                    this->uWritten  -= uStaged;
+                }
+
+                return uSent;
+            }
+
+            std::span<std::byte>
+            BorrowWrite(size_t uMinSize) {
+                if (!this->DropRead())
+                    return {};
+                if (this->uBufferSize - this->uWritten < uMinSize && !this->FlushWrite())
+                    return {};
+                if (this->uBufferSize - this->uWritten < std::max<size_t>(uMinSize, 1))
+                    return {};
+
+                return { this->lpBuffer.get() + this->uWritten, this->uBufferSize - this->uWritten };
+            }
+
+            void
+            Commit(size_t uCount) {
+                this->uWritten  += uCount;
+            }
+
+            bool
+            Fill() {
+                if (!this->FlushWrite())
+                    return false;
+
+                this->uBegin    = 0;
+                this->uEnd      = this->ReadDirect({ this->lpBuffer.get(), this->uBufferSize });
+                return this->uEnd != 0;
+            }
+
+            bool
+            FlushWrite() {
+                if (this->uWritten == 0)
+                    return !this->bErr;
+
+                size_t
+                    uCount  = this->WriteDirect({ this->lpBuffer.get(), this->uWritten });
+                if (uCount != this->uWritten) {
+                    memmove(this->lpBuffer.get(), this->lpBuffer.get() + uCount, this->uWritten - uCount);
+                    this->uWritten  -= uCount;
+                    return false;
+                }
+
+                this->uWritten  = 0;
+                return !this->bErr;
+            }
+
+            bool
+            DropRead() {
+                if (this->uBegin == this->uEnd)
+                    return true;
+
+                if (lseek(this->fd, -(off_t)(this->uEnd - this->uBegin), SEEK_CUR) < 0) {
+                    this->bErr  = true;
+                    return false;
+                }
+
+                this->uBegin    = 0;
+                this->uEnd      = 0;
+                return true;
+            }
+
+            size_t
+            ReadDirect(std::span<std::byte> buffer) {
+                struct iovec
+                    vec     = { buffer.data(), buffer.size() };
+                return this->ReadDirectV(&vec, 1);
+            }
+
+            size_t
+            ReadDirectV(const struct iovec* lpVec, size_t uVecs) {
+                if (this->dropBehind.uWindow != 0) {
+                    off_t
+                        offset  = lseek(this->fd, 0, SEEK_CUR);
+                    if (offset >= 0)
+                        this->dropBehind.Advance(this->fd, (uint64_t)offset);
+                }
+
+                for (;;) {
+                    ssize_t
+                        iResult = readv(this->fd, lpVec, (int)uVecs);
+                    if (iResult < 0 && errno == EINTR)
+                        continue;
+
+                    if (iResult == 0)
+                        this->bEOF  = true;
+                    else if (iResult < 0)
+                        this->bErr  = true;
+                    return iResult > 0 ? (size_t)iResult : 0;
+                }
+            }
+
+            size_t
+            WriteDirect(std::span<const std::byte> buffer) {
+                size_t
+                    uWritten    = 0;
+                while (uWritten != buffer.size()) {
+                    ssize_t
+                        iResult = write(this->fd, buffer.data() + uWritten, buffer.size() - uWritten);
+                    if (iResult < 0 && errno == EINTR)
+                        continue;
+                    if (iResult <= 0) {
+                        this->bErr  = true;
+                        break;
+                    }
+                    uWritten    += (size_t)iResult;
+                }
+
+                return uWritten;
+            }
+
+            static constexpr size_t
+                uMaxVec     = 64;
+
+            int
+                fd          = -1;
+            std::unique_ptr<std::byte[]>
+                lpBuffer;
+            size_t
+                uBufferSize = 0,
+                uBegin      = 0,
+                uEnd        = 0,
+                uWritten    = 0;
+            DropBehind
+                dropBehind;
+            bool
+                bEOF        = false,
+                bErr        = false;
+        };
+
+        class FdStreamBase :
+            public FdStreamViewBase {
+        public:
+            FdStreamBase(const FdStreamBase&) = delete;
+            FdStreamBase(FdStreamBase&& obj) noexcept :
+                FdStreamViewBase(std::move(obj)) {}
+
+            FdStreamBase&
+            operator=(const FdStreamBase&) = delete;
+            FdStreamBase&
+            operator=(FdStreamBase&& obj) noexcept {
+                FdStreamBase
+                    temp    = std::move(obj);
+                std::swap(this->fd, temp.fd);
+                std::swap(this->lpBuffer, temp.lpBuffer);
+                std::swap(this->uBufferSize, temp.uBufferSize);
+                std::swap(this->uBegin, temp.uBegin);
+                std::swap(this->uEnd, temp.uEnd);
+                std::swap(this->uWritten, temp.uWritten);
+                std::swap(this->dropBehind, temp.dropBehind);
+                std::swap(this->bEOF, temp.bEOF);
+                std::swap(this->bErr, temp.bErr);
+                return *this;
+            }
+
+            FdStreamBase(int fd, size_t uBufferSize) :
+                FdStreamViewBase(fd, uBufferSize)
+            {
+                if (this->fd < 0)
+                    throw std::runtime_error("invalid file descriptor");
+            }
+
+            FdStreamBase(std::string_view strvFilename, int iFlags, size_t uBufferSize) :
+                FdStreamViewBase(open(std::string(strvFilename).c_str(), iFlags | O_CLOEXEC, 0666), uBufferSize)
+            {
+                if (this->fd < 0) {
+                    throw std::runtime_error(std::format(
+                        "failed to open file {}: {}",
+                        strvFilename, strerror(errno)));
+                }
+            }
+
+            ~FdStreamBase() noexcept {
+                if (this->fd != -1) {
+                    this->FlushWrite();
+                    close(this->fd);
+                    this->fd    = -1;
+                }
+            }
+        };
+    }
+
+    class IFdStreamView final :
+        public  IStream,
+        public  __impl::FdStreamViewBase {
+    public:
+        IFdStreamView(int fd, size_t uBufferSize = uDefaultBufferSize) :
+            FdStreamViewBase(fd, uBufferSize) {}
+
+        std::optional<std::byte>
+        Read() override {
+            return this->FdStreamViewBase::Read();
+        }
+
+        size_t
+        ReadSome(std::span<std::byte> buffer) override {
+            return this->FdStreamViewBase::ReadSome(buffer);
+        }
+
+        size_t
+        ReadSomeV(std::span<const std::span<std::byte>> buffers) override {
+            return this->FdStreamViewBase::ReadSomeV(buffers);
+        }
+
+        bool
+        PutBack(std::byte c) override {
+            return this->FdStreamViewBase::PutBack(c);
+        }
+
+        std::span<const std::byte>
+        BorrowRead() override {
+            return this->FdStreamViewBase::BorrowRead();
+        }
+
+        void
+        Consume(size_t uCount) override {
+            this->FdStreamViewBase::Consume(uCount);
+        }
+
+        size_t
+        ReadAt(uint64_t uOffset, std::span<std::byte> buffer) override {
+            return this->FdStreamViewBase::ReadAt(uOffset, buffer);
+        }
+    };
+
+    class OFdStreamView final :
+        public  OStream,
+        public  __impl::FdStreamViewBase {
+    public:
+        OFdStreamView(int fd, size_t uBufferSize = uDefaultBufferSize) :
+            FdStreamViewBase(fd, uBufferSize) {}
+
+        bool
+        Write(std::byte c) override {
+            return this->FdStreamViewBase::Write(c);
+        }
+
+        size_t
+        WriteSome(std::span<const std::byte> buffer) override {
+            return this->FdStreamViewBase::WriteSome(buffer);
+        }
+
+        size_t
+        WriteSomeV(std::span<const std::span<const std::byte>> buffers) override {
+            return this->FdStreamViewBase::WriteSomeV(buffers);
+        }
+
+        std::span<std::byte>
+        BorrowWrite(size_t uMinSize) override {
+            return this->FdStreamViewBase::BorrowWrite(uMinSize);
+        }
+
+        void
+        Commit(size_t uCount) override {
+            this->FdStreamViewBase::Commit(uCount);
+        }
+
+        size_t
+        WriteAt(uint64_t uOffset, std::span<const std::byte> buffer) override {
+            return this->FdStreamViewBase::WriteAt(uOffset, buffer);
+        }
+    };
+
+    class IOFdStreamView final :
+        public  IOStream,
+        public  __impl::FdStreamViewBase {
+    public:
+        IOFdStreamView(int fd, size_t uBufferSize = uDefaultBufferSize) :
+            FdStreamViewBase(fd, uBufferSize) {}
+
+        std::optional<std::byte>
+        Read() override {
+            return this->FdStreamViewBase::Read();
+        }
+
+        size_t
+        ReadSome(std::span<std::byte> buffer) override {
+            return this->FdStreamViewBase::ReadSome(buffer);
+        }
+
+        size_t
+        ReadSomeV(std::span<const std::span<std::byte>> buffers) override {
+            return this->FdStreamViewBase::ReadSomeV(buffers);
+        }
+
+        bool
+        PutBack(std::byte c) override {
+            return this->FdStreamViewBase::PutBack(c);
+        }
+
+        std::span<const std::byte>
+        BorrowRead() override {
+            return this->FdStreamViewBase::BorrowRead();
+        }
+
+        void
+        Consume(size_t uCount) override {
+            this->FdStreamViewBase::Consume(uCount);
+        }
+
+        bool
+        Write(std::byte c) override {
+            return this->FdStreamViewBase::Write(c);
+        }
+
+        size_t
+        WriteSome(std::span<const std::byte> buffer) override {
+            return this->FdStreamViewBase::WriteSome(buffer);
+        }
+
+        size_t
+        WriteSomeV(std::span<const std::span<const std::byte>> buffers) override {
+            return this->FdStreamViewBase::WriteSomeV(buffers);
+        }
+
+        std::span<std::byte>
+        BorrowWrite(size_t uMinSize) override {
+            return this->FdStreamViewBase::BorrowWrite(uMinSize);
+        }
+
+        void
+        Commit(size_t uCount) override {
+            this->FdStreamViewBase::Commit(uCount);
+        }
+
+        size_t
+        ReadAt(uint64_t uOffset, std::span<std::byte> buffer) override {
+            return this->FdStreamViewBase::ReadAt(uOffset, buffer);
+        }
+
+        size_t
+        WriteAt(uint64_t uOffset, std::span<const std::byte> buffer) override {
+            return this->FdStreamViewBase::WriteAt(uOffset, buffer);
+        }
+    };
+
+    class IFdStream final :
+        public  IStream,
+        public  __impl::FdStreamBase {
+    public:
+        IFdStream(int fd, size_t uBufferSize = uDefaultBufferSize) :
+            FdStreamBase(fd, uBufferSize) {}
+
+        IFdStream(
+            std::string_view    strvFilename,
+            int                 iFlags      = O_RDONLY,
+            size_t              uBufferSize = uDefaultBufferSize) :
+            FdStreamBase(strvFilename, iFlags, uBufferSize) {}
+
+        std::optional<std::byte>
+        Read() override {
+            return this->FdStreamBase::Read();
+        }
+
+        size_t
+        ReadSome(std::span<std::byte> buffer) override {
+            return this->FdStreamBase::ReadSome(buffer);
+        }
+
+        size_t
+        ReadSomeV(std::span<const std::span<std::byte>> buffers) override {
+            return this->FdStreamBase::ReadSomeV(buffers);
+        }
+
+        bool
+        PutBack(std::byte c) override {
+            return this->FdStreamBase::PutBack(c);
+        }
+
+        std::span<const std::byte>
+        BorrowRead() override {
+            return this->FdStreamBase::BorrowRead();
+        }
+
+        void
+        Consume(size_t uCount) override {
+            this->FdStreamBase::Consume(uCount);
+        }
+
+        size_t
+        ReadAt(uint64_t uOffset, std::span<std::byte> buffer) override {
+            return this->FdStreamBase::ReadAt(uOffset, buffer);
+        }
+    };
+
+    class OFdStream final :
+        public  OStream,
+        public  __impl::FdStreamBase {
+    public:
+        OFdStream(int fd, size_t uBufferSize = uDefaultBufferSize) :
+            FdStreamBase(fd, uBufferSize) {}
+
+        OFdStream(
+            std::string_view    strvFilename,
+            int                 iFlags      = O_WRONLY | O_CREAT | O_TRUNC,
+            size_t              uBufferSize = uDefaultBufferSize) :
+            FdStreamBase(strvFilename, iFlags, uBufferSize) {}
+
+        bool
+        Write(std::byte c) override {
+            return this->FdStreamBase::Write(c);
+        }
+
+        size_t
+        WriteSome(std::span<const std::byte> buffer) override {
+            return this->FdStreamBase::WriteSome(buffer);
+        }
+
+        size_t
+        WriteSomeV(std::span<const std::span<const std::byte>> buffers) override {
+            return this->FdStreamBase::WriteSomeV(buffers);
+        }
+
+        std::span<std::byte>
+        BorrowWrite(size_t uMinSize) override {
+            return this->FdStreamBase::BorrowWrite(uMinSize);
+        }
+
+        void
+        Commit(size_t uCount) override {
+            this->FdStreamBase::Commit(uCount);
+        }
+
+        size_t
+        WriteAt(uint64_t uOffset, std::span<const std::byte> buffer) override {
+            return this->FdStreamBase::WriteAt(uOffset, buffer);
+        }
+    };
+
+    class IOFdStream final :
+        public  IOStream,
+        public  __impl::FdStreamBase {
+    public:
+        IOFdStream(int fd, size_t uBufferSize = uDefaultBufferSize) :
+            FdStreamBase(fd, uBufferSize) {}
+
+        IOFdStream(
+            std::string_view    strvFilename,
+            int                 iFlags      = O_RDWR | O_CREAT,
+            size_t              uBufferSize = uDefaultBufferSize) :
+            FdStreamBase(strvFilename, iFlags, uBufferSize) {}
+
+        std::optional<std::byte>
+        Read() override {
+            return this->FdStreamBase::Read();
+        }
+
+        size_t
+        ReadSome(std::span<std::byte> buffer) override {
+            return this->FdStreamBase::ReadSome(buffer);
+        }
+
+        size_t
+        ReadSomeV(std::span<const std::span<std::byte>> buffers) override {
+            return this->FdStreamBase::ReadSomeV(buffers);
+        }
+
+        bool
+        PutBack(std::byte c) override {
+            return this->FdStreamBase::PutBack(c);
+        }
+
+        std::span<const std::byte>
+        BorrowRead() override {
+            return this->FdStreamBase::BorrowRead();
+        }
+
+        void
+        Consume(size_t uCount) override {
+            this->FdStreamBase::Consume(uCount);
+        }
+
+        bool
+        Write(std::byte c) override {
+            return this->FdStreamBase::Write(c);
+        }
+
+        size_t
+        WriteSome(std::span<const std::byte> buffer) override {
+            return this->FdStreamBase::WriteSome(buffer);
+        }
+
+        size_t
+        WriteSomeV(std::span<const std::span<const std::byte>> buffers) override {
+            return this->FdStreamBase::WriteSomeV(buffers);
+        }
+
+        std::span<std::byte>
+        BorrowWrite(size_t uMinSize) override {
+            return this->FdStreamBase::BorrowWrite(uMinSize);
+        }
+
+        void
+        Commit(size_t uCount) override {
+            this->FdStreamBase::Commit(uCount);
+        }
+
+        size_t
+        ReadAt(uint64_t uOffset, std::span<std::byte> buffer) override {
+            return this->FdStreamBase::ReadAt(uOffset, buffer);
+        }
+
+        size_t
+        WriteAt(uint64_t uOffset, std::span<const std::byte> buffer) override {
+            return this->FdStreamBase::WriteAt(uOffset, buffer);
+        }
+    };
+}
@@ -1,13 +1,37 @@
 #pragma once
+#include <atomic>
 #include <cstdio>
 #include <format>
+#include <new>
+#include <optional>
 #include <stdexcept>
 #include <string_view>
+#include <thread>
 
 #include "IOStreams.hpp"
+#include "DescriptorIO.hpp"
 
 
 namespace io {
+    enum class BufferMode {
+        Full    = _IOFBF,
+        Line    = _IOLBF,
+        None    = _IONBF
+    };
+
+    // setvbuf() settings; they must be applied before the first I/O on the
+    // handle. a caller-supplied lpData of uSize bytes has to outlive it
+    struct FileBuffer {
+        BufferMode
+            mode    = BufferMode::Full;
+        size_t
+            uSize   = 0;        // 0 keeps the size stdio would pick
+        char*
+            lpData  = nullptr;
+    };
+
+    class FileLockSession;
+
     namespace __impl {
         class SerialFileStreamViewBase :
             virtual public  StreamState {
@@ -40,11 +64,54 @@ namespace io {
                 return fflush(this->handle) == 0;
             }
 
+            int
+            SyncDescriptor() noexcept override {
+                if (fflush(this->handle) != 0)
+                    return -1;
+                return fileno(this->handle);
+            }
+
+            // stdio ignores the size unless it is handed the storage too, so
+            // a size without lpData gets a buffer the stream allocates. views
+            // never free it: their handle, stdout say, is flushed at exit()
+            bool
+            SetBuffering(const FileBuffer& buffer) noexcept {
+                char*
+                    lpData  = buffer.lpData;
+                if (lpData == nullptr && buffer.uSize != 0 && buffer.mode != BufferMode::None) {
+                    lpData  = new (std::nothrow) char[buffer.uSize];
+                    if (lpData == nullptr)
+                        return false;
+                }
+
+                int
+                    iResult = setvbuf(
+                                this->handle,
+                                lpData,
+                                (int)buffer.mode,
+                                (buffer.uSize != 0) ? buffer.uSize : BUFSIZ);
+                if (lpData == buffer.lpData)
+                    return iResult == 0;
+
+                if (iResult != 0) {
+                    delete[] lpData;
+                    return false;
+                }
+
+                delete[] this->lpOwnedBuffer;
+                this->lpOwnedBuffer = lpData;
+                return true;
+            }
+
         protected:
+            friend class io::FileLockSession;
+
             std::optional<std::byte>
             Read() {
                 auto c =
-                    fgetc(this->handle);
+                    this->Unlocked()
+                        ? getc_unlocked(this->handle)
+                        : fgetc(this->handle);
                 return (c != EOF)
                     ? std::optional{ (std::byte)c }
                     : std::nullopt;
@@ -52,6 +119,14 @@ namespace io {
 
             size_t
             ReadSome(std::span<std::byte> buffer) {
+#if defined(__GLIBC__)
+                if (this->Unlocked()) {
+                    return fread_unlocked(
+                        buffer.data(),
+                        1, buffer.size(),
+                        this->handle);
+                }
+#endif
                 return fread(
                     buffer.data(),
                     1, buffer.size(),
@@ -61,12 +136,22 @@ namespace io {
             bool
             Write(std::byte c) {
                 auto result =
-                    fputc((int)c, this->handle);
+                    this->Unlocked()
+                        ? putc_unlocked((int)c, this->handle)
+                        : fputc((int)c, this->handle);
                 return result != EOF;
             }
 
             size_t
             WriteSome(std::span<const std::byte> buffer) {
+#if defined(__GLIBC__)
+                if (this->Unlocked()) {
+                    return fwrite_unlocked(
+                        buffer.data(),
+                        1, buffer.size(),
+                        this->handle);
+                }
+#endif
                 return fwrite(
                     buffer.data(),
                     1, buffer.size(),
@@ -78,8 +163,85 @@ namespace io {
                 return ungetc((int)c, this->handle) != EOF;
             }
 
+            // the windows point into the FILE's own buffer, so they are only
+            // handed to the thread holding its lock through a FileLockSession
+            std::span<const std::byte>
+            BorrowRead() {
+#if defined(__GLIBC__)
+                if (!this->Unlocked() || this->handle->_IO_write_ptr > this->handle->_IO_write_base)
+                    return {};
+
+                if (this->handle->_IO_read_ptr == this->handle->_IO_read_end) {
+                    int c   = getc_unlocked(this->handle);
+                    if (c == EOF)
+                        return {};
+                    ungetc(c, this->handle);
+                }
+
+                return {
+                    (const std::byte*)this->handle->_IO_read_ptr,
+                    (size_t)(this->handle->_IO_read_end - this->handle->_IO_read_ptr) };
+#else
+                return {};
+#endif
+            }
+
+            void
+            Consume(size_t uCount) {
+#if defined(__GLIBC__)
+                this->handle->_IO_read_ptr  += uCount;
+#else
+                (void)uCount;
+#endif
+            }
+
+            std::span<std::byte>
+            BorrowWrite(size_t uMinSize) {
+#if defined(__GLIBC__)
+                if (!this->Unlocked())
+                    return {};
+
+                size_t
+                    uFree   = (size_t)(this->handle->_IO_write_end - this->handle->_IO_write_ptr);
+                if (uFree < uMinSize && this->handle->_IO_write_ptr > this->handle->_IO_write_base) {
+                    if (fflush(this->handle) != 0)
+                        return {};
+                    uFree   = (size_t)(this->handle->_IO_write_end - this->handle->_IO_write_ptr);
+                }
+                if (uFree == 0 || uFree < uMinSize)
+                    return {};
+
+                return { (std::byte*)this->handle->_IO_write_ptr, uFree };
+#else
+                (void)uMinSize;
+                return {};
+#endif
+            }
+
+            void
+            Commit(size_t uCount) {
+#if defined(__GLIBC__)
+                this->handle->_IO_write_ptr += uCount;
+#else
+                (void)uCount;
+#endif
+            }
+
+            // only the thread holding a FileLockSession may skip the FILE
+            // lock; the others keep the locking calls and wait on flockfile
+            [[nodiscard]] bool
+            Unlocked() const noexcept {
+                return this->idOwner.load(std::memory_order_relaxed) == std::this_thread::get_id();
+            }
+
             FILE*
-                handle = nullptr;
+                handle          = nullptr;
+            char*
+                lpOwnedBuffer   = nullptr;
+            std::atomic<std::thread::id>
+                idOwner;
+            unsigned
+                uSessions       = 0;    // nesting depth, guarded by the FILE lock
         };
 
         class FileStreamViewBase :
@@ -89,6 +251,11 @@ namespace io {
             FileStreamViewBase(FILE* hFile) :
                 SerialFileStreamViewBase(hFile) {}
 
+            bool
+            Advise(AccessHint hint, uint64_t uOffset = 0, uint64_t uLength = 0) noexcept {
+                return AdviseDescriptor(fileno(this->handle), hint, uOffset, uLength);
+            }
+
             [[nodiscard]] intptr_t
             GetPosition() const noexcept override {
                 return ftell(this->handle);
@@ -104,6 +271,25 @@ namespace io {
                     offset,
                     (int)from);
             }
+
+        protected:
+            // buffered writes are pushed out first so that positional reads
+            // see them and they cannot later land on top of a positional write
+            size_t
+            ReadAt(uint64_t uOffset, std::span<std::byte> buffer) {
+                if (fflush(this->handle) != 0)
+                    return 0;
+
+                return PositionalRead(fileno(this->handle), uOffset, buffer);
+            }
+
+            size_t
+            WriteAt(uint64_t uOffset, std::span<const std::byte> buffer) {
+                if (fflush(this->handle) != 0)
+                    return 0;
+
+                return PositionalWrite(fileno(this->handle), uOffset, buffer);
+            }
         };
 
         class SerialFileStreamBase :
@@ -113,7 +299,9 @@ namespace io {
             SerialFileStreamBase(SerialFileStreamBase&& obj) noexcept :
                 SerialFileStreamViewBase(obj.handle)
             {
-                obj.handle      = nullptr;
+                this->lpOwnedBuffer = obj.lpOwnedBuffer;
+                obj.handle          = nullptr;
+                obj.lpOwnedBuffer   = nullptr;
             }
 
             SerialFileStreamBase&
@@ -124,10 +312,15 @@ namespace io {
                     temp    = std::move(obj);
                 std::swap(
                     this->handle, temp.handle);
+                std::swap(
+                    this->lpOwnedBuffer, temp.lpOwnedBuffer);
                 return *this;
             }
 
-            SerialFileStreamBase(std::string_view strvFilename, std::string_view strvMode) :
+            SerialFileStreamBase(
+                std::string_view            strvFilename,
+                std::string_view            strvMode,
+                std::optional<FileBuffer>   optBuffer = std::nullopt) :
                 SerialFileStreamViewBase(fopen(strvFilename.data(), strvMode.data()))
             {
                 if (this->handle == nullptr) {
@@ -135,11 +328,19 @@ namespace io {
                         "failed to open file {} with mode {}",
                         strvFilename, strvMode));
                 }
+
+                if (optBuffer && !this->SetBuffering(*optBuffer)) {
+                    fclose(this->handle);
+                    throw std::runtime_error(std::format(
+                        "failed to set buffering of file {}",
+                        strvFilename));
+                }
             }
 
             ~SerialFileStreamBase() noexcept {
                 if (this->handle != nullptr)
                     fclose(this->handle);
+                delete[] this->lpOwnedBuffer;
             }
         };
 
@@ -151,7 +352,9 @@ namespace io {
             FileStreamBase(FileStreamBase&& obj) noexcept :
                 FileStreamViewBase(obj.handle)
             {
-                obj.handle      = nullptr;
+                this->lpOwnedBuffer = obj.lpOwnedBuffer;
+                obj.handle          = nullptr;
+                obj.lpOwnedBuffer   = nullptr;
             }
 
             FileStreamBase&
@@ -162,10 +365,15 @@ namespace io {
                     temp    = std::move(obj);
                 std::swap(
                     this->handle, temp.handle);
+                std::swap(
+                    this->lpOwnedBuffer, temp.lpOwnedBuffer);
                 return *this;
             }
 
-            FileStreamBase(std::string_view strvFilename, std::string_view strvMode) :
+            FileStreamBase(
+                std::string_view            strvFilename,
+                std::string_view            strvMode,
+                std::optional<FileBuffer>   optBuffer = std::nullopt) :
                 FileStreamViewBase(fopen(strvFilename.data(), strvMode.data()))
             {
                 if (this->handle == nullptr) {
@@ -173,16 +381,52 @@ namespace io {
                         "failed to open file {} with mode {}",
                         strvFilename, strvMode));
                 }
+
+                if (optBuffer && !this->SetBuffering(*optBuffer)) {
+                    fclose(this->handle);
+                    throw std::runtime_error(std::format(
+                        "failed to set buffering of file {}",
+                        strvFilename));
+                }
             }
 
             ~FileStreamBase() noexcept {
                 if (this->handle != nullptr)
                     fclose(this->handle);
+                delete[] this->lpOwnedBuffer;
             }
         };
     }
 
-    class IFileStreamView :
+    // holds the handle's lock for a whole stretch of I/O on the current
+    // thread, switching the stream to the unlocked stdio calls for that
+    // thread only. other threads keep locking and wait until it ends
+    class FileLockSession {
+    public:
+        FileLockSession(__impl::SerialFileStreamViewBase& stream) noexcept :
+            refStream(stream)
+        {
+            flockfile(this->refStream.handle);
+            if (this->refStream.uSessions++ == 0)
+                this->refStream.idOwner.store(std::this_thread::get_id(), std::memory_order_relaxed);
+        }
+
+        FileLockSession(const FileLockSession&) = delete;
+        FileLockSession&
+        operator=(const FileLockSession&) = delete;
+
+        ~FileLockSession() noexcept {
+            if (--this->refStream.uSessions == 0)
+                this->refStream.idOwner.store(std::thread::id{}, std::memory_order_relaxed);
+            funlockfile(this->refStream.handle);
+        }
+
+    private:
+        __impl::SerialFileStreamViewBase&
+            refStream;
+    };
+
+    class IFileStreamView final :
         public  IStream,
         public  __impl::FileStreamViewBase {
     public:
@@ -203,9 +447,24 @@ namespace io {
         PutBack(std::byte c) override {
             return this->FileStreamViewBase::PutBack(c);
         }
+
+        std::span<const std::byte>
+        BorrowRead() override {
+            return this->FileStreamViewBase::BorrowRead();
+        }
+
+        void
+        Consume(size_t uCount) override {
+            this->FileStreamViewBase::Consume(uCount);
+        }
+
+        size_t
+        ReadAt(uint64_t uOffset, std::span<std::byte> buffer) override {
+            return this->FileStreamViewBase::ReadAt(uOffset, buffer);
+        }
     };
 
-    class OFileStreamView :
+    class OFileStreamView final :
         public  OStream,
         public  __impl::FileStreamViewBase {
     public:
@@ -221,9 +480,24 @@ namespace io {
         WriteSome(std::span<const std::byte> buffer) override {
             return this->FileStreamViewBase::WriteSome(buffer);
         }
+
+        std::span<std::byte>
+        BorrowWrite(size_t uMinSize) override {
+            return this->FileStreamViewBase::BorrowWrite(uMinSize);
+        }
+
+        void
+        Commit(size_t uCount) override {
+            this->FileStreamViewBase::Commit(uCount);
+        }
+
+        size_t
+        WriteAt(uint64_t uOffset, std::span<const std::byte> buffer) override {
+            return this->FileStreamViewBase::WriteAt(uOffset, buffer);
+        }
     };
 
-    class IOFileStreamView :
+    class IOFileStreamView final :
         public  IOStream,
         public  __impl::FileStreamViewBase {
     public:
@@ -245,6 +519,16 @@ namespace io {
             return this->FileStreamViewBase::PutBack(c);
         }
 
+        std::span<const std::byte>
+        BorrowRead() override {
+            return this->FileStreamViewBase::BorrowRead();
+        }
+
+        void
+        Consume(size_t uCount) override {
+            this->FileStreamViewBase::Consume(uCount);
+        }
+
         bool
         Write(std::byte c) override {
             return this->FileStreamViewBase::Write(c);
@@ -254,14 +538,34 @@ namespace io {
         WriteSome(std::span<const std::byte> buffer) override {
             return this->FileStreamViewBase::WriteSome(buffer);
         }
+
+        std::span<std::byte>
+        BorrowWrite(size_t uMinSize) override {
+            return this->FileStreamViewBase::BorrowWrite(uMinSize);
+        }
+
+        void
+        Commit(size_t uCount) override {
+            this->FileStreamViewBase::Commit(uCount);
+        }
+
+        size_t
+        ReadAt(uint64_t uOffset, std::span<std::byte> buffer) override {
+            return this->FileStreamViewBase::ReadAt(uOffset, buffer);
+        }
+
+        size_t
+        WriteAt(uint64_t uOffset, std::span<const std::byte> buffer) override {
+            return this->FileStreamViewBase::WriteAt(uOffset, buffer);
+        }
     };
 
-    class IFileStream :
+    class IFileStream final :
         public  IStream,
         public  __impl::FileStreamBase {
     public:
-        IFileStream(std::string_view strvFilename) :
-            FileStreamBase(strvFilename, "r") {}
+        IFileStream(std::string_view strvFilename, std::optional<FileBuffer> optBuffer = std::nullopt) :
+            FileStreamBase(strvFilename, "r", optBuffer) {}
 
         std::optional<std::byte>
         Read() override {
@@ -277,14 +581,29 @@ namespace io {
         PutBack(std::byte c) override {
             return this->FileStreamBase::PutBack(c);
         }
+
+        std::span<const std::byte>
+        BorrowRead() override {
+            return this->FileStreamBase::BorrowRead();
+        }
+
+        void
+        Consume(size_t uCount) override {
+            this->FileStreamBase::Consume(uCount);
+        }
+
+        size_t
+        ReadAt(uint64_t uOffset, std::span<std::byte> buffer) override {
+            return this->FileStreamBase::ReadAt(uOffset, buffer);
+        }
     };
 
-    class OFileStream :
+    class OFileStream final :
         public  OStream,
         public  __impl::FileStreamBase {
     public:
-        OFileStream(std::string_view strvFilename) :
-            FileStreamBase(strvFilename, "w") {}
+        OFileStream(std::string_view strvFilename, std::optional<FileBuffer> optBuffer = std::nullopt) :
+            FileStreamBase(strvFilename, "w", optBuffer) {}
 
         bool
         Write(std::byte c) override {
@@ -295,14 +614,29 @@ namespace io {
         WriteSome(std::span<const std::byte> buffer) override {
             return this->FileStreamBase::WriteSome(buffer);
         }
+
+        std::span<std::byte>
+        BorrowWrite(size_t uMinSize) override {
+            return this->FileStreamBase::BorrowWrite(uMinSize);
+        }
+
+        void
+        Commit(size_t uCount) override {
+            this->FileStreamBase::Commit(uCount);
+        }
+
+        size_t
+        WriteAt(uint64_t uOffset, std::span<const std::byte> buffer) override {
+            return this->FileStreamBase::WriteAt(uOffset, buffer);
+        }
     };
 
-    class IOFileStream :
+    class IOFileStream final :
         public  IOStream,
         public  __impl::FileStreamBase {
     public:
-        IOFileStream(std::string_view strvFilename) :
-            FileStreamBase(strvFilename, "r+") {}
+        IOFileStream(std::string_view strvFilename, std::optional<FileBuffer> optBuffer = std::nullopt) :
+            FileStreamBase(strvFilename, "r+", optBuffer) {}
 
         bool
         Write(std::byte c) override {
@@ -314,6 +648,16 @@ namespace io {
             return this->FileStreamBase::WriteSome(buffer);
         }
 
+        std::span<std::byte>
+        BorrowWrite(size_t uMinSize) override {
+            return this->FileStreamBase::BorrowWrite(uMinSize);
+        }
+
+        void
+        Commit(size_t uCount) override {
+            this->FileStreamBase::Commit(uCount);
+        }
+
         std::optional<std::byte>
         Read() override {
             return this->FileStreamBase::Read();
@@ -328,9 +672,29 @@ namespace io {
         PutBack(std::byte c) override {
             return this->FileStreamBase::PutBack(c);
         }
+
+        std::span<const std::byte>
+        BorrowRead() override {
+            return this->FileStreamBase::BorrowRead();
+        }
+
+        void
+        Consume(size_t uCount) override {
+            this->FileStreamBase::Consume(uCount);
+        }
+
+        size_t
+        ReadAt(uint64_t uOffset, std::span<std::byte> buffer) override {
+            return this->FileStreamBase::ReadAt(uOffset, buffer);
+        }
+
+        size_t
+        WriteAt(uint64_t uOffset, std::span<const std::byte> buffer) override {
+            return this->FileStreamBase::WriteAt(uOffset, buffer);
+        }
     };
 
-    class SerialIFileStreamView :
+    class SerialIFileStreamView final :
         public  SerialIStream,
         public  __impl::SerialFileStreamViewBase {
     public:
@@ -351,9 +715,19 @@ namespace io {
         PutBack(std::byte c) override {
             return this->SerialFileStreamViewBase::PutBack(c);
         }
+
+        std::span<const std::byte>
+        BorrowRead() override {
+            return this->SerialFileStreamViewBase::BorrowRead();
+        }
+
+        void
+        Consume(size_t uCount) override {
+            this->SerialFileStreamViewBase::Consume(uCount);
+        }
     };
 
-    class SerialOFileStreamView :
+    class SerialOFileStreamView final :
         public  SerialOStream,
         public  __impl::SerialFileStreamViewBase {
     public:
@@ -369,9 +743,19 @@ namespace io {
         WriteSome(std::span<const std::byte> buffer) override {
             return this->SerialFileStreamViewBase::WriteSome(buffer);
         }
+
+        std::span<std::byte>
+        BorrowWrite(size_t uMinSize) override {
+            return this->SerialFileStreamViewBase::BorrowWrite(uMinSize);
+        }
+
+        void
+        Commit(size_t uCount) override {
+            this->SerialFileStreamViewBase::Commit(uCount);
+        }
     };
 
-    class SerialIOFileStreamView :
+    class SerialIOFileStreamView final :
         public  SerialIOStream,
         public  __impl::SerialFileStreamViewBase {
     public:
@@ -393,6 +777,16 @@ namespace io {
             return this->SerialFileStreamViewBase::PutBack(c);
         }
 
+        std::span<const std::byte>
+        BorrowRead() override {
+            return this->SerialFileStreamViewBase::BorrowRead();
+        }
+
+        void
+        Consume(size_t uCount) override {
+            this->SerialFileStreamViewBase::Consume(uCount);
+        }
+
         bool
         Write(std::byte c) override {
             return this->SerialFileStreamViewBase::Write(c);
@@ -402,14 +796,24 @@ namespace io {
         WriteSome(std::span<const std::byte> buffer) override {
             return this->SerialFileStreamViewBase::WriteSome(buffer);
         }
+
+        std::span<std::byte>
+        BorrowWrite(size_t uMinSize) override {
+            return this->SerialFileStreamViewBase::BorrowWrite(uMinSize);
+        }
+
+        void
+        Commit(size_t uCount) override {
+            this->SerialFileStreamViewBase::Commit(uCount);
+        }
     };
 
-    class SerialIFileStream :
+    class SerialIFileStream final :
         public  SerialIStream,
         public  __impl::SerialFileStreamBase {
     public:
-        SerialIFileStream(std::string_view strvFilename) :
-            SerialFileStreamBase(strvFilename, "r") {}
+        SerialIFileStream(std::string_view strvFilename, std::optional<FileBuffer> optBuffer = std::nullopt) :
+            SerialFileStreamBase(strvFilename, "r", optBuffer) {}
 
         std::optional<std::byte>
         Read() override {
@@ -425,14 +829,24 @@ namespace io {
         PutBack(std::byte c) override {
             return this->SerialFileStreamBase::PutBack(c);
         }
+
+        std::span<const std::byte>
+        BorrowRead() override {
+            return this->SerialFileStreamBase::BorrowRead();
+        }
+
+        void
+        Consume(size_t uCount) override {
+            this->SerialFileStreamBase::Consume(uCount);
+        }
     };
 
-    class SerialOFileStream :
+    class SerialOFileStream final :
         public  SerialOStream,
         public  __impl::SerialFileStreamBase {
     public:
-        SerialOFileStream(std::string_view strvFilename) :
-            SerialFileStreamBase(strvFilename, "w") {}
+        SerialOFileStream(std::string_view strvFilename, std::optional<FileBuffer> optBuffer = std::nullopt) :
+            SerialFileStreamBase(strvFilename, "w", optBuffer) {}
 
         bool
         Write(std::byte c) override {
@@ -443,14 +857,24 @@ namespace io {
         WriteSome(std::span<const std::byte> buffer) override {
             return this->SerialFileStreamBase::WriteSome(buffer);
         }
+
+        std::span<std::byte>
+        BorrowWrite(size_t uMinSize) override {
+            return this->SerialFileStreamBase::BorrowWrite(uMinSize);
+        }
+
+        void
+        Commit(size_t uCount) override {
+            this->SerialFileStreamBase::Commit(uCount);
+        }
     };
 
-    class SerialIOFileStream :
+    class SerialIOFileStream final :
         public  SerialIOStream,
         public  __impl::SerialFileStreamBase {
     public:
-        SerialIOFileStream(std::string_view strvFilename) :
-            SerialFileStreamBase(strvFilename, "r+") {}
+        SerialIOFileStream(std::string_view strvFilename, std::optional<FileBuffer> optBuffer = std::nullopt) :
+            SerialFileStreamBase(strvFilename, "r+", optBuffer) {}
 
         bool
         Write(std::byte c) override {
@@ -462,6 +886,16 @@ namespace io {
             return this->SerialFileStreamBase::WriteSome(buffer);
         }
 
+        std::span<std::byte>
+        BorrowWrite(size_t uMinSize) override {
+            return this->SerialFileStreamBase::BorrowWrite(uMinSize);
+        }
+
+        void
+        Commit(size_t uCount) override {
+            this->SerialFileStreamBase::Commit(uCount);
+        }
+
         std::optional<std::byte>
         Read() override {
             return this->SerialFileStreamBase::Read();
@@ -476,6 +910,16 @@ namespace io {
         PutBack(std::byte c) override {
             return this->SerialFileStreamBase::PutBack(c);
         }
+
+        std::span<const std::byte>
+        BorrowRead() override {
+            return this->SerialFileStreamBase::BorrowRead();
+        }
+
+        void
+        Consume(size_t uCount) override {
+            this->SerialFileStreamBase::Consume(uCount);
+        }
     };
 }
 
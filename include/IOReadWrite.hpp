@@ -1,13 +1,236 @@
 #pragma once
 #include <format>
+#include <charconv>
+#include <memory>
 #include <concepts>
+#include <algorithm>
 #include <string_view>
 
 #include "IOStreams.hpp"
 
+#if defined(__linux__)
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/sendfile.h>
+#endif
+
 
 namespace io {
     namespace __impl {
+        struct ScanStep {
+            size_t
+                uConsumed   = 0;
+            bool
+                bDone       = false;
+        };
+
+        template<typename StreamT, typename FnScan>
+        void
+        ScanInput(StreamT& is, FnScan&& fnScan) {
+            for (;;) {
+                std::span<const std::byte>
+                    window  = is.BorrowRead();
+                if (!window.empty()) {
+                    ScanStep
+                        step    = fnScan(window);
+                    is.Consume(step.uConsumed);
+                    if (step.bDone)
+                        return;
+                    continue;
+                }
+
+                std::optional<std::byte>
+                    optc    = is.Read();
+                if (!optc)
+                    return;
+
+                ScanStep
+                    step    = fnScan(std::span<const std::byte>{ &*optc, 1 });
+                if (step.uConsumed == 0)
+                    is.PutBack(*optc);
+                if (step.bDone)
+                    return;
+            }
+        }
+
+        template<typename StreamT>
+        void
+        SkipSpaces(StreamT& is) {
+            ScanInput(is,
+                [](std::span<const std::byte> window) -> ScanStep {
+                    for (size_t i = 0; i != window.size(); ++i) {
+                        if (!isspace((int)window[i]))
+                            return { i, true };
+                    }
+                    return { window.size(), false };
+                });
+        }
+
+        template<typename StreamT, typename FnDelim>
+        void
+        ScanUntil(StreamT& is, FnDelim&& fnIsDelim, bool bEatDelim, auto&& fnSink) {
+            ScanInput(is,
+                [&](std::span<const std::byte> window) -> ScanStep {
+                    for (size_t i = 0; i != window.size(); ++i) {
+                        if (fnIsDelim((char)window[i])) {
+                            fnSink(window.first(i));
+                            return { bEatDelim ? i + 1 : i, true };
+                        }
+                    }
+                    fnSink(window);
+                    return { window.size(), false };
+                });
+        }
+
+        // one step of a kernel-side copy between two descriptors. walks down
+        // copy_file_range, sendfile and splice as each turns out not to apply
+        class KernelCopy {
+        public:
+            // bytes moved, 0 at the end of input, -1 once no path is left
+            intptr_t
+            Step(int fdIn, int fdOut, size_t uCount) noexcept {
+#if defined(__linux__)
+                while (this->method != Method::None) {
+                    ssize_t
+                        iMoved  = -1;
+                    switch (this->method) {
+                    case Method::CopyFileRange:
+                        iMoved  = copy_file_range(fdIn, nullptr, fdOut, nullptr, uCount, 0);
+                        break;
+
+                    case Method::SendFile:
+                        iMoved  = sendfile(fdOut, fdIn, nullptr, uCount);
+                        break;
+
+                    case Method::Splice:
+                        iMoved  = splice(fdIn, nullptr, fdOut, nullptr, uCount, SPLICE_F_MOVE);
+                        break;
+
+                    case Method::None:
+                        break;
+                    }
+
+                    if (iMoved >= 0)
+                        return (intptr_t)iMoved;
+                    if (errno == EINTR)
+                        continue;
+                    if (errno != EINVAL && errno != EXDEV && errno != ENOSYS &&
+                        errno != EOPNOTSUPP && errno != ESPIPE && errno != EBADF)
+                        break;
+
+                    this->method    = (Method)((int)this->method + 1);
+                }
+#else
+                (void)fdIn; (void)fdOut; (void)uCount;
+#endif
+                this->method    = Method::None;
+                return -1;
+            }
+
+        private:
+            enum class Method {
+                CopyFileRange,
+                SendFile,
+                Splice,
+                None
+            };
+
+            Method
+                method  = Method::CopyFileRange;
+        };
+
+        template<typename StreamT>
+        int
+        TransferDescriptorOf(const StreamT& stream) noexcept {
+            if constexpr (requires { { stream.TransferDescriptor() } -> std::convertible_to<int>; })
+                return stream.TransferDescriptor();
+            else
+                return -1;
+        }
+    }
+
+    // moves up to uByteCount bytes from one stream into another. while both
+    // sit directly on descriptors the kernel copies them; otherwise, and for
+    // bytes either side still buffers, it goes through large ReadSome and
+    // WriteSome chunks. returns the number of bytes moved
+    template<io::SerialReadable InT, io::SerialWritable OutT>
+    size_t
+    Transfer(InT& from, OutT& to, size_t uByteCount = SIZE_MAX) {
+        static constexpr size_t
+            uChunkSize      = 256 * 1024,
+            uMaxKernelStep  = 1 << 30;
+
+        __impl::KernelCopy
+            kernel;
+        std::unique_ptr<std::byte[]>
+            lpChunk;
+        size_t
+            uTotal  = 0;
+        bool
+            bKernel = true;
+        while (uTotal != uByteCount) {
+            size_t
+                uLeft   = uByteCount - uTotal;
+            if (bKernel) {
+                int
+                    fdIn    = __impl::TransferDescriptorOf(from);
+                if (fdIn >= 0 && __impl::TransferDescriptorOf(to) < 0)
+                    to.Flush();
+
+                int
+                    fdOut   = __impl::TransferDescriptorOf(to);
+                if (fdIn >= 0 && fdOut < 0) {
+                    // flushed and still no descriptor: the output has none,
+                    // so don't flush it again for every chunk
+                    bKernel = false;
+                } else if (fdIn >= 0 && fdIn != fdOut) {
+                    intptr_t
+                        iMoved  = kernel.Step(fdIn, fdOut, std::min(uLeft, uMaxKernelStep));
+                    if (iMoved > 0) {
+                        uTotal  += (size_t)iMoved;
+                        continue;
+                    }
+
+                    // end of input or no kernel path: the stream path below
+                    // either reports it properly or carries on copying
+                    bKernel = false;
+                }
+            }
+
+            std::span<const std::byte>
+                window  = from.BorrowRead();
+            if (!window.empty()) {
+                window  = window.first(std::min(window.size(), uLeft));
+                size_t
+                    uWritten    = to.WriteSome(window);
+                from.Consume(uWritten);
+                uTotal  += uWritten;
+                if (uWritten != window.size())
+                    break;
+                continue;
+            }
+
+            if (!lpChunk)
+                lpChunk.reset(new std::byte[uChunkSize]);
+
+            size_t
+                uRead   = from.ReadSome({ lpChunk.get(), std::min(uChunkSize, uLeft) });
+            if (uRead == 0)
+                break;
+
+            size_t
+                uWritten    = to.WriteSome({ lpChunk.get(), uRead });
+            uTotal  += uWritten;
+            if (uWritten != uRead)
+                break;
+        }
+
+        return uTotal;
+    }
+
+    namespace __impl {
+
         class TextOutputBase {
         public:
             const auto&
@@ -33,19 +256,10 @@ namespace io {
             template<std::integral I>
             const auto&
             put_int(this const auto& self, I val, int base = 10) {
-                char
-                    lpcTemp[32];
-
-                std::to_chars_result
-                    result  = std::to_chars(
-                                std::begin(lpcTemp),
-                                std::end(lpcTemp),
-                                val, base);
-                *result.ptr = '\0'; 
-                
-                std::string_view
-                    strvInt     = ((bool)result.ec) ? lpcTemp : "errint";
-                return self.put_str(strvInt);
+                return self.put_chars("errint",
+                    [&](char* lpcFirst, char* lpcLast) {
+                        return std::to_chars(lpcFirst, lpcLast, val, base);
+                    });
             }
 
             template<std::integral I>
@@ -75,40 +289,19 @@ namespace io {
             template<std::floating_point F>
             const auto&
             put_float(this auto& self, F val) {
-                char
-                    lpcTemp[32];
-                
-                std::to_chars_result
-                    result  = std::to_chars(
-                                std::begin(lpcTemp),
-                                std::end(lpcTemp),
-                                val,
-                                std::chars_format::fixed);
-                *result.ptr = '\0';
-
-                std::string_view
-                    strvFloat   = ((bool)result.ec) ? lpcTemp : "errfloat";
-                return self.put_str(strvFloat);
+                return self.put_chars("errfloat",
+                    [&](char* lpcFirst, char* lpcLast) {
+                        return std::to_chars(lpcFirst, lpcLast, val, std::chars_format::fixed);
+                    });
             }
 
             template<std::floating_point F>
             const auto&
             put_float_p(this auto& self, F val, int precision) {
-                char
-                    lpcTemp[32];
-                
-                std::to_chars_result
-                    result  = std::to_chars(
-                                std::begin(lpcTemp),
-                                std::end(lpcTemp),
-                                val,
-                                std::chars_format::fixed,
-                                precision);
-                *result.ptr = '\0';
-
-                std::string_view
-                    strvFloat   = ((bool)result.ec) ? lpcTemp : "errfloat";
-                return self.put_str(strvFloat);
+                return self.put_chars("errfloat",
+                    [&](char* lpcFirst, char* lpcLast) {
+                        return std::to_chars(lpcFirst, lpcLast, val, std::chars_format::fixed, precision);
+                    });
             }
 
             template<typename... Args>
@@ -183,6 +376,36 @@ namespace io {
             forward_bin_from(this const auto& self, io::SerialIStream& from) {
                 return self.export_int(from, 2);
             }
+
+        protected:
+            const auto&
+            put_chars(this const auto& self, std::string_view strvError, auto&& fnFormat) {
+                constexpr size_t
+                    uMaxChars   = 64;
+                std::span<std::byte>
+                    window  = self.stream().BorrowWrite(uMaxChars);
+                if (!window.empty()) {
+                    char*
+                        lpcFirst    = (char*)window.data();
+                    std::to_chars_result
+                        result      = fnFormat(lpcFirst, lpcFirst + uMaxChars);
+                    if (result.ec == std::errc{}) {
+                        self.stream().Commit((size_t)(result.ptr - lpcFirst));
+                        return self;
+                    }
+
+                    self.stream().Commit(0);
+                    return self.put_str(strvError);
+                }
+
+                char
+                    lpcTemp[uMaxChars];
+                std::to_chars_result
+                    result  = fnFormat(std::begin(lpcTemp), std::end(lpcTemp));
+                return self.put_str((result.ec == std::errc{})
+                    ? std::string_view(lpcTemp, result.ptr)
+                    : strvError);
+            }
         };
 
         class TextInputBase {
@@ -200,22 +423,12 @@ namespace io {
             get_word(this const auto& self, std::string& out) {
                 std::string
                     strWord;
-                std::optional<std::byte>
-                    optc;
-                while ((bool)(optc = self.stream().Read())) {
-                    if (!isspace((int)*optc)) {
-                        self.stream().PutBack(*optc);
-                        break;
-                    }
-                }
-                while ((bool)(optc = self.stream().Read())) {
-                    if (isspace((int)*optc)) {
-                        self.stream().PutBack(*optc);
-                        break;
-                    }
-
-                    strWord.push_back((char)*optc);
-                }
+                SkipSpaces(self.stream());
+                ScanUntil(self.stream(),
+                    [](char c) { return isspace((int)c) != 0; }, false,
+                    [&](std::span<const std::byte> bytes) {
+                        strWord.append((const char*)bytes.data(), bytes.size());
+                    });
 
                 out = std::move(strWord);
                 return self;
@@ -225,15 +438,11 @@ namespace io {
             get_line(this const auto& self, std::string& out) {
                 std::string
                     strLine;
-                std::optional<std::byte>
-                    optc;
-                while ((bool)(optc = self.stream().Read())) {
-                    if ((char)*optc == '\n') {
-                        break;
-                    }
-                    
-                    strLine += (char)*optc;
-                }
+                ScanUntil(self.stream(),
+                    [](char c) { return c == '\n'; }, true,
+                    [&](std::span<const std::byte> bytes) {
+                        strLine.append((const char*)bytes.data(), bytes.size());
+                    });
 
                 out = std::move(strLine);
                 return self;
@@ -243,11 +452,11 @@ namespace io {
             get_all(this const auto& self, std::string& out) {
                 std::string
                     strAll;
-                std::optional<std::byte>
-                    optc;
-                while ((bool)(optc = self.stream().Read())) {
-                    strAll += (char)*optc;
-                }
+                ScanUntil(self.stream(),
+                    [](char) { return false; }, false,
+                    [&](std::span<const std::byte> bytes) {
+                        strAll.append((const char*)bytes.data(), bytes.size());
+                    });
 
                 out = std::move(strAll);
                 return self;
@@ -314,89 +523,42 @@ namespace io {
 
             const auto&
             get_float(this const auto& self, std::floating_point auto& out) {
+                enum class State {
+                    FirstChar,
+                    NaturalPart,
+                    FractionalPart
+                };
+
                 char
                     lpcBuffer[32];
                 size_t
-                    uSize = 0;
-                std::optional<std::byte>
-                    optc;
-            
-            ParseSpacing:
-                if ((bool)(optc = self.stream().Read())) {
-                    if (!isspace((int)*optc)) {
-                        self.stream().PutBack(*optc);
-                        goto ParseFirstChar;
-                    }
-                    else
-                        goto ParseSpacing;
-                }
-                else
-                    return self;
-
-            ParseFirstChar:
-                if ((bool)(optc = self.stream().Read())) {
-                    char c = (char)*optc;
-                    
-                    if (c == '-' || c == '+' || isdigit(c)) {
-                        lpcBuffer[uSize] = c;
-                        uSize += 1;
-                        goto ParseNaturalPart;
-                    }
-                    else if (c == '.' || c == ',') {
-                        lpcBuffer[uSize] = '.';
-                        uSize += 1;
-                        goto ParseFractionalPart;
-                    }
-                    else {
-                        self.stream().PutBack(*optc);
-                        return self;
-                    }
-                }
-                else
-                    return self;
-
-            ParseNaturalPart:
-                if (uSize == sizeof(lpcBuffer))
-                    goto GenerateValue;
-                if ((bool)(optc = self.stream().Read())) {
-                    char c = (char)*optc;
-                    if (isdigit(c)) {
-                        lpcBuffer[uSize] = c;
-                        uSize += 1;
-                        goto ParseNaturalPart;
-                    }
-                    else if (c == '.' || c == ',') {
-                        lpcBuffer[uSize] = '.';
-                        uSize += 1;
-                        goto ParseFractionalPart;
-                    }
-                    else {
-                        self.stream().PutBack(*optc);
-                        goto GenerateValue;
-                    }
-                }
-                else
-                    goto GenerateValue;
-
-            ParseFractionalPart:
-                if (uSize == sizeof(lpcBuffer))
-                    goto GenerateValue;
-                if ((bool)(optc = self.stream().Read())) {
-                    char c = (char)*optc;
-                    if (isdigit(c)) {
-                        lpcBuffer[uSize] = c;
-                        uSize += 1;
-                        goto ParseFractionalPart;
-                    }
-                    else {
-                        self.stream().PutBack(*optc);
-                        goto GenerateValue;
-                    }
-                }
-                else
-                    goto GenerateValue;
+                    uSize   = 0;
+                State
+                    state   = State::FirstChar;
+
+                SkipSpaces(self.stream());
+                ScanInput(self.stream(),
+                    [&](std::span<const std::byte> window) -> ScanStep {
+                        for (size_t i = 0; i != window.size(); ++i) {
+                            char c = (char)window[i];
+                            if (state != State::FirstChar && uSize == sizeof(lpcBuffer))
+                                return { i, true };
+
+                            if (state != State::FractionalPart && (c == '.' || c == ',')) {
+                                lpcBuffer[uSize++]  = '.';
+                                state               = State::FractionalPart;
+                            }
+                            else if (isdigit(c) || (state == State::FirstChar && (c == '-' || c == '+'))) {
+                                lpcBuffer[uSize++]  = c;
+                                if (state == State::FirstChar)
+                                    state   = State::NaturalPart;
+                            }
+                            else
+                                return { i, true };
+                        }
+                        return { window.size(), false };
+                    });
 
-            GenerateValue:
                 std::from_chars(
                     lpcBuffer, lpcBuffer + uSize,
                     out, std::chars_format::fixed);
@@ -470,57 +632,27 @@ namespace io {
                     lpcBuffer[32];
                 size_t
                     uSize = 0;
-                std::optional<std::byte>
-                    optc;
-                
-            ParseSpacing:
-                if ((bool)(optc = self.stream().Read())) {
-                    if (!isspace((int)*optc)) {
-                        self.stream().PutBack(*optc);
-                        goto ParseFirstChar;
-                    }
-                    else
-                        goto ParseSpacing;
-                }
-                else
-                    return self;
 
-            ParseFirstChar:
-                if ((bool)(optc = self.stream().Read())) {
-                    char c = (char)*optc;
-                    
-                    if (c == '-' || c == '+' || isdigit(c)) {
-                        lpcBuffer[uSize] = c;
-                        uSize += 1;
-                        goto ParseDigits;
-                    }
-                    else {
-                        self.stream().PutBack(*optc);
-                        return self;
-                    }
-                }
-                else
-                    return self;
-
-            ParseDigits:
-                if (uSize == sizeof(lpcBuffer))
-                    goto GenerateValue;
-                if ((bool)(optc = self.stream().Read())) {
-                    char c = (char)*optc;
-                    if (fnIsDigit(c)) {
-                        lpcBuffer[uSize] = c;
-                        uSize += 1;
-                        goto ParseDigits;
-                    }
-                    else {
-                        self.stream().PutBack(*optc);
-                        goto GenerateValue;
-                    }
-                }
-                else
-                    goto GenerateValue;
+                SkipSpaces(self.stream());
+                ScanInput(self.stream(),
+                    [&](std::span<const std::byte> window) -> ScanStep {
+                        for (size_t i = 0; i != window.size(); ++i) {
+                            char c = (char)window[i];
+                            if (uSize == sizeof(lpcBuffer))
+                                return { i, true };
+
+                            bool
+                                bAccept = (uSize == 0)
+                                    ? (c == '-' || c == '+' || isdigit(c))
+                                    : fnIsDigit(c);
+                            if (!bAccept)
+                                return { i, true };
+
+                            lpcBuffer[uSize++] = c;
+                        }
+                        return { window.size(), false };
+                    });
 
-            GenerateValue:
                 std::from_chars(
                     lpcBuffer, lpcBuffer + uSize,
                     out, base);
@@ -900,6 +1032,136 @@ namespace io {
             refStream;
     };
 
+    namespace __impl {
+        template<typename StreamT>
+        using IOBaseOf =
+            std::conditional_t<io::Seekable<StreamT>, RandomAccessIOBase, SerialIOBase>;
+    }
+
+    template<io::SerialReadable StreamT>
+    class TextInputOf :
+        public __impl::IOBaseOf<StreamT>,
+        public __impl::TextInputBase {
+    public:
+        TextInputOf(const TextInputOf&) = delete;
+
+        TextInputOf(StreamT& is) :
+            refStream(is) {}
+
+        auto&
+        stream() const noexcept {
+            return this->refStream;
+        }
+
+    private:
+        StreamT&
+            refStream;
+    };
+
+    template<io::SerialWritable StreamT>
+    class TextOutputOf :
+        public __impl::IOBaseOf<StreamT>,
+        public __impl::TextOutputBase {
+    public:
+        TextOutputOf(const TextOutputOf&) = delete;
+
+        TextOutputOf(StreamT& os) :
+            refStream(os) {}
+
+        auto&
+        stream() const noexcept {
+            return this->refStream;
+        }
+
+    private:
+        StreamT&
+            refStream;
+    };
+
+    template<typename StreamT> requires
+        io::SerialReadable<StreamT> && io::SerialWritable<StreamT>
+    class TextIOOf :
+        public __impl::IOBaseOf<StreamT>,
+        public __impl::TextInputBase,
+        public __impl::TextOutputBase {
+    public:
+        TextIOOf(const TextIOOf&) = delete;
+
+        TextIOOf(StreamT& ios) :
+            refStream(ios) {}
+
+        auto&
+        stream() const noexcept {
+            return this->refStream;
+        }
+
+    private:
+        StreamT&
+            refStream;
+    };
+
+    template<io::SerialReadable StreamT>
+    class BinaryInputOf :
+        public __impl::IOBaseOf<StreamT>,
+        public __impl::BinaryInputBase {
+    public:
+        BinaryInputOf(const BinaryInputOf&) = delete;
+
+        BinaryInputOf(StreamT& is) :
+            refStream(is) {}
+
+        auto&
+        stream() const noexcept {
+            return this->refStream;
+        }
+
+    private:
+        StreamT&
+            refStream;
+    };
+
+    template<io::SerialWritable StreamT>
+    class BinaryOutputOf :
+        public __impl::IOBaseOf<StreamT>,
+        public __impl::BinaryOutputBase {
+    public:
+        BinaryOutputOf(const BinaryOutputOf&) = delete;
+
+        BinaryOutputOf(StreamT& os) :
+            refStream(os) {}
+
+        auto&
+        stream() const noexcept {
+            return this->refStream;
+        }
+
+    private:
+        StreamT&
+            refStream;
+    };
+
+    template<typename StreamT> requires
+        io::SerialReadable<StreamT> && io::SerialWritable<StreamT>
+    class BinaryIOOf :
+        public __impl::IOBaseOf<StreamT>,
+        public __impl::BinaryInputBase,
+        public __impl::BinaryOutputBase {
+    public:
+        BinaryIOOf(const BinaryIOOf&) = delete;
+
+        BinaryIOOf(StreamT& ios) :
+            refStream(ios) {}
+
+        auto&
+        stream() const noexcept {
+            return this->refStream;
+        }
+
+    private:
+        StreamT&
+            refStream;
+    };
+
     namespace __impl {
         const auto&
         TextOutputBase::forward_char_from(this const auto& self, io::SerialIStream& from) {
@@ -936,49 +1198,30 @@ namespace io {
 
         const auto&
         TextOutputBase::forward_word_from(this const auto& self, io::SerialIStream& from) {
-            std::optional<std::byte>
-                optc;
-            while ((bool)(optc = from.Read())) {
-                if (!isspace((int)*optc)) {
-                    from.PutBack(*optc);
-                    break;
-                }
-            }
-            while ((bool)(optc = from.Read())) {
-                if (isspace((int)*optc)) {
-                    from.PutBack(*optc);
-                    break;
-                }
-
-                self.stream().Write(*optc);
-            }
+            SkipSpaces(from);
+            ScanUntil(from,
+                [](char c) { return isspace((int)c) != 0; }, false,
+                [&](std::span<const std::byte> bytes) {
+                    self.stream().WriteSome(bytes);
+                });
 
             return self;
         }
 
         const auto&
         TextOutputBase::forward_line_from(this const auto& self, io::SerialIStream& from) {
-            std::optional<std::byte>
-                optc;
-            while ((bool)(optc = from.Read())) {
-                if ((char)*optc == '\n') {
-                    break;
-                }
-
-                self.stream().Write(*optc);
-            }
+            ScanUntil(from,
+                [](char c) { return c == '\n'; }, true,
+                [&](std::span<const std::byte> bytes) {
+                    self.stream().WriteSome(bytes);
+                });
 
             return self;
         }
 
         const auto&
         TextOutputBase::forward_all_from(this const auto& self, io::SerialIStream& from) {
-            std::optional<std::byte>
-                optc;
-            while ((bool)(optc = from.Read())) {
-                self.stream().Write(*optc);
-            }
-
+            io::Transfer(from, self.stream());
             return self;
         }
 
@@ -993,49 +1236,30 @@ namespace io {
 
         const auto&
         TextInputBase::forward_word_to(this const auto& self, io::SerialOStream& to) {
-            std::optional<std::byte>
-                optc;
-            while ((bool)(optc = self.stream().Read())) {
-                if (!isspace((int)*optc)) {
-                    self.stream().PutBack(*optc);
-                    break;
-                }
-            }
-            while ((bool)(optc = self.stream().Read())) {
-                if (isspace((int)*optc)) {
-                    self.stream().PutBack(*optc);
-                    break;
-                }
-
-                to.Write(*optc);
-            }
+            SkipSpaces(self.stream());
+            ScanUntil(self.stream(),
+                [](char c) { return isspace((int)c) != 0; }, false,
+                [&](std::span<const std::byte> bytes) {
+                    to.WriteSome(bytes);
+                });
 
             return self;
         }
 
         const auto&
         TextInputBase::forward_line_to(this const auto& self, io::SerialOStream& to) {
-            std::optional<std::byte>
-                optc;
-            while ((bool)(optc = self.stream().Read())) {
-                if ((char)*optc == '\n') {
-                    break;
-                }
-
-                to.Write(*optc);
-            }
+            ScanUntil(self.stream(),
+                [](char c) { return c == '\n'; }, true,
+                [&](std::span<const std::byte> bytes) {
+                    to.WriteSome(bytes);
+                });
 
             return self;
         }
 
         const auto&
         TextInputBase::forward_all_to(this const auto& self, io::SerialOStream& to) {
-            std::optional<std::byte>
-                optc;
-            while ((bool)(optc = self.stream().Read())) {
-                to.Write(*optc);
-            }
-
+            io::Transfer(self.stream(), to);
             return self;
         }
 
@@ -1071,15 +1295,10 @@ namespace io {
 
         const auto&
         BinaryOutputBase::forward_data_from(this const auto& self, io::SerialIStream& from, size_t uByteCount) {
-            while (uByteCount != 0) {
-                std::optional<std::byte>
-                    optc = from.Read();
-                if (!optc)
-                    break;
-                self.stream().Write(*optc);
-                uByteCount -= 1;
-            }
+            if (uByteCount == 0)
+                return self;
 
+            io::Transfer(from, self.stream(), uByteCount);
             return self;
         }
 
@@ -1105,15 +1324,10 @@ namespace io {
 
         const auto&
         BinaryInputBase::forward_data_to(this const auto& self, io::SerialOStream& to, size_t uByteCount) {
-            while (uByteCount != 0) {
-                std::optional<std::byte>
-                    optc = self.stream().Read();
-                if (!optc)
-                    break;
-                to.Write(*optc);
-                uByteCount -= 1;
-            }
+            if (uByteCount == 0)
+                return self;
 
+            io::Transfer(self.stream(), to, uByteCount);
             return self;
         }
 
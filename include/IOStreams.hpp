@@ -3,6 +3,7 @@
 #include <cstdint>
 #include <cstddef>
 #include <optional>
+#include <concepts>
 
 namespace io {
     enum class StreamOffsetOrigin {
@@ -29,6 +30,22 @@ namespace io {
             virtual bool
             Flush() noexcept = 0;
 
+            // descriptor a kernel-side copy may use in place of the stream.
+            // only handed out while nothing is buffered on top of it, so the
+            // descriptor's file offset is the stream position; -1 otherwise
+            virtual int
+            TransferDescriptor() const noexcept {
+                return -1;
+            }
+
+            // descriptor the stream's data ends up in, with everything
+            // buffered above it pushed down so it can be synced to disk;
+            // -1 when the stream doesn't sit on one
+            virtual int
+            SyncDescriptor() noexcept {
+                return -1;
+            }
+
             inline operator bool() const noexcept {
                 return this->Good();
             }
@@ -63,8 +80,36 @@ namespace io {
         ReadSome(
             std::span<std::byte> buffer) = 0;
 
+        virtual size_t
+        ReadSomeV(
+            std::span<const std::span<std::byte>> buffers)
+        {
+            size_t
+                uTotal  = 0;
+            for (std::span<std::byte> buffer : buffers) {
+                size_t
+                    uRead   = this->ReadSome(buffer);
+                uTotal  += uRead;
+                if (uRead != buffer.size())
+                    break;
+            }
+
+            return uTotal;
+        }
+
         virtual bool
         PutBack(std::byte c) = 0;
+
+        // exposes already buffered bytes without copying them, refilling
+        // the buffer if it's empty. an empty window means the stream has
+        // nothing to lend right now and Read() should be used instead
+        virtual std::span<const std::byte>
+        BorrowRead() {
+            return {};
+        }
+
+        virtual void
+        Consume(size_t /*uCount*/) {}
     };
 
     class SerialOStream :
@@ -79,6 +124,34 @@ namespace io {
         virtual size_t
         WriteSome(
             std::span<const std::byte> buffer) = 0;
+
+        virtual size_t
+        WriteSomeV(
+            std::span<const std::span<const std::byte>> buffers)
+        {
+            size_t
+                uTotal  = 0;
+            for (std::span<const std::byte> buffer : buffers) {
+                size_t
+                    uWritten    = this->WriteSome(buffer);
+                uTotal  += uWritten;
+                if (uWritten != buffer.size())
+                    break;
+            }
+
+            return uTotal;
+        }
+
+        // lends at least uMinSize bytes of the stream's own buffer to be
+        // filled in place and then published with Commit(). an empty
+        // window means WriteSome() should be used instead
+        virtual std::span<std::byte>
+        BorrowWrite(size_t /*uMinSize*/) {
+            return {};
+        }
+
+        virtual void
+        Commit(size_t /*uCount*/) {}
     };
 
     class SerialIOStream :
@@ -87,13 +160,85 @@ namespace io {
 
     class IStream :
         virtual public  __impl::StreamPosition,
-        public          SerialIStream {};
+        public          SerialIStream {
+    public:
+        // positional reads leave the cursor where it was. streams that
+        // override this may run them concurrently with each other; the
+        // default seeks there and back and so may not
+        virtual size_t
+        ReadAt(
+            uint64_t                uOffset,
+            std::span<std::byte>    buffer)
+        {
+            intptr_t
+                iCurPos = this->GetPosition();
+            if (iCurPos < 0 || !this->SetPosition((intptr_t)uOffset))
+                return 0;
+
+            size_t
+                uRead   = this->ReadSome(buffer);
+            this->SetPosition(iCurPos);
+            return uRead;
+        }
+    };
 
     class OStream :
         virtual public  __impl::StreamPosition,
-        public          SerialOStream {};
+        public          SerialOStream {
+    public:
+        virtual size_t
+        WriteAt(
+            uint64_t                    uOffset,
+            std::span<const std::byte>  buffer)
+        {
+            intptr_t
+                iCurPos = this->GetPosition();
+            if (iCurPos < 0 || !this->SetPosition((intptr_t)uOffset))
+                return 0;
+
+            size_t
+                uWritten    = this->WriteSome(buffer);
+            this->SetPosition(iCurPos);
+            return uWritten;
+        }
+    };
 
     class IOStream :
         public  IStream,
         public  OStream {};
+
+    template<typename StreamT>
+    concept StreamStateful = requires(StreamT& stream) {
+        { stream.EndOfStream() }    -> std::convertible_to<bool>;
+        { stream.Good() }           -> std::convertible_to<bool>;
+        { stream.Flush() }          -> std::convertible_to<bool>;
+        stream.ClearFlags();
+    };
+
+    template<typename StreamT>
+    concept SerialReadable =
+        StreamStateful<StreamT> &&
+        requires(StreamT& stream, std::span<std::byte> buffer, std::byte c, size_t uCount) {
+            { stream.Read() }           -> std::same_as<std::optional<std::byte>>;
+            { stream.ReadSome(buffer) } -> std::convertible_to<size_t>;
+            { stream.PutBack(c) }       -> std::convertible_to<bool>;
+            { stream.BorrowRead() }     -> std::convertible_to<std::span<const std::byte>>;
+            stream.Consume(uCount);
+        };
+
+    template<typename StreamT>
+    concept SerialWritable =
+        StreamStateful<StreamT> &&
+        requires(StreamT& stream, std::span<const std::byte> buffer, std::byte c, size_t uCount) {
+            { stream.Write(c) }             -> std::convertible_to<bool>;
+            { stream.WriteSome(buffer) }    -> std::convertible_to<size_t>;
+            { stream.BorrowWrite(uCount) }  -> std::convertible_to<std::span<std::byte>>;
+            stream.Commit(uCount);
+        };
+
+    template<typename StreamT>
+    concept Seekable = requires(StreamT& stream, intptr_t offset, StreamOffsetOrigin from) {
+        { stream.GetPosition() }            -> std::convertible_to<intptr_t>;
+        { stream.SetPosition(offset, from) }-> std::convertible_to<bool>;
+    };
 }
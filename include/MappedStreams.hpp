@@ -0,0 +1,578 @@
+#pragma once
+#include <cerrno>
+#include <cstring>
+#include <format>
+#include <algorithm>
+#include <string>
+#include <stdexcept>
+#include <string_view>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "IOStreams.hpp"
+#include "SpanStreams.hpp"
+#include "DescriptorIO.hpp"
+
+
+namespace io {
+    enum class MapSync {
+        Async   = MS_ASYNC,
+        Sync    = MS_SYNC
+    };
+
+    namespace __impl {
+        inline bool
+        AdviseMapping(void* lpMapping, size_t uMappingSize, AccessHint hint, uint64_t uOffset, uint64_t uLength) noexcept {
+            if (lpMapping == nullptr || uOffset >= uMappingSize)
+                return false;
+
+            size_t
+                uPage   = (size_t)sysconf(_SC_PAGESIZE),
+                uFirst  = (size_t)uOffset / uPage * uPage,
+                uLast   = (uLength == 0 || uLength > uMappingSize - uOffset)
+                    ? uMappingSize
+                    : (size_t)(uOffset + uLength);
+
+            int iAdvice = MADV_NORMAL;
+            switch (hint) {
+            case AccessHint::Normal:
+                iAdvice = MADV_NORMAL;
+                break;
+
+            case AccessHint::Sequential:
+                iAdvice = MADV_SEQUENTIAL;
+                break;
+
+            case AccessHint::Random:
+                iAdvice = MADV_RANDOM;
+                break;
+
+            case AccessHint::WillNeed:
+                iAdvice = MADV_WILLNEED;
+                break;
+
+            case AccessHint::DontNeed:
+                iAdvice = MADV_DONTNEED;
+                break;
+            }
+
+            return madvise((std::byte*)lpMapping + uFirst, uLast - uFirst, iAdvice) == 0;
+        }
+
+        class ReadOnlyFileMapping {
+        public:
+            ReadOnlyFileMapping(std::string_view strvFilename, AccessHint hint, bool bPopulate) {
+                int fd  = open(std::string(strvFilename).c_str(), O_RDONLY | O_CLOEXEC);
+                if (fd < 0) {
+                    throw std::runtime_error(std::format(
+                        "failed to open file {}: {}",
+                        strvFilename, strerror(errno)));
+                }
+
+                struct stat
+                    st;
+                if (fstat(fd, &st) != 0) {
+                    int iError  = errno;
+                    close(fd);
+                    throw std::runtime_error(std::format(
+                        "failed to stat file {}: {}",
+                        strvFilename, strerror(iError)));
+                }
+
+                this->uMappingSize   = (size_t)st.st_size;
+                if (this->uMappingSize != 0) {
+                    int iFlags  = MAP_SHARED;
+#if defined(MAP_POPULATE)
+                    if (bPopulate)
+                        iFlags  |= MAP_POPULATE;
+#else
+                    (void)bPopulate;
+#endif
+                    void* lpMapping =
+                        mmap(nullptr, this->uMappingSize, PROT_READ, iFlags, fd, 0);
+                    if (lpMapping == MAP_FAILED) {
+                        int iError  = errno;
+                        close(fd);
+                        throw std::runtime_error(std::format(
+                            "failed to map file {}: {}",
+                            strvFilename, strerror(iError)));
+                    }
+
+                    this->lpMappingData  = (const std::byte*)lpMapping;
+                    if (hint != AccessHint::Normal)
+                        AdviseMapping(lpMapping, this->uMappingSize, hint, 0, 0);
+                }
+
+                close(fd);
+            }
+
+            ReadOnlyFileMapping(const ReadOnlyFileMapping&) = delete;
+            ReadOnlyFileMapping&
+            operator=(const ReadOnlyFileMapping&) = delete;
+
+            ~ReadOnlyFileMapping() noexcept {
+                if (this->lpMappingData != nullptr)
+                    munmap((void*)this->lpMappingData, this->uMappingSize);
+            }
+
+            bool
+            Advise(AccessHint hint, uint64_t uOffset = 0, uint64_t uLength = 0) const noexcept {
+                return AdviseMapping((void*)this->lpMappingData, this->uMappingSize, hint, uOffset, uLength);
+            }
+
+        protected:
+            [[nodiscard]] std::span<const std::byte>
+            Mapping() const noexcept {
+                return { this->lpMappingData, this->uMappingSize };
+            }
+
+            const std::byte*
+                lpMappingData   = nullptr;
+            size_t
+                uMappingSize    = 0;
+        };
+
+        class WritableFileMapping :
+            virtual public  StreamState,
+            virtual public  StreamPosition {
+        public:
+            static constexpr size_t
+                uMinGrowth  = 1024 * 1024;
+
+            WritableFileMapping(std::string_view strvFilename, int iFlags, MapSync sync) :
+                fd(open(std::string(strvFilename).c_str(), O_RDWR | O_CREAT | O_CLOEXEC | iFlags, 0666)),
+                sync(sync)
+            {
+                if (this->fd < 0) {
+                    throw std::runtime_error(std::format(
+                        "failed to open file {}: {}",
+                        strvFilename, strerror(errno)));
+                }
+
+                struct stat
+                    st;
+                if (fstat(this->fd, &st) != 0) {
+                    int iError  = errno;
+                    close(this->fd);
+                    throw std::runtime_error(std::format(
+                        "failed to stat file {}: {}",
+                        strvFilename, strerror(iError)));
+                }
+
+                this->uSize     = (size_t)st.st_size;
+                this->uCapacity = this->uSize;
+                if (this->uSize != 0 && !this->Remap(this->uSize)) {
+                    int iError  = errno;
+                    close(this->fd);
+                    throw std::runtime_error(std::format(
+                        "failed to map file {}: {}",
+                        strvFilename, strerror(iError)));
+                }
+            }
+
+            WritableFileMapping(const WritableFileMapping&) = delete;
+            WritableFileMapping&
+            operator=(const WritableFileMapping&) = delete;
+
+            ~WritableFileMapping() noexcept {
+                if (this->lpData != nullptr)
+                    munmap(this->lpData, this->uMapped);
+                if (this->uCapacity != this->uSize)
+                    (void)ftruncate(this->fd, (off_t)this->uSize);
+                close(this->fd);
+            }
+
+            [[nodiscard]] bool
+            EndOfStream() const noexcept override {
+                return this->bEOF;
+            }
+
+            [[nodiscard]] bool
+            Good() const noexcept override {
+                return !this->bErr;
+            }
+
+            void
+            ClearFlags() noexcept override {
+                this->bEOF  = false;
+                this->bErr  = false;
+            }
+
+            bool
+            Flush() noexcept override {
+                return this->Sync(this->sync);
+            }
+
+            bool
+            Sync(MapSync mode) noexcept {
+                if (this->lpData != nullptr && msync(this->lpData, this->uMapped, (int)mode) != 0)
+                    return false;
+
+                if (this->uCapacity != this->uSize) {
+                    if (ftruncate(this->fd, (off_t)this->uSize) != 0)
+                        return false;
+                    this->uCapacity = this->uSize;
+                }
+
+                return !this->bErr;
+            }
+
+            [[nodiscard]] intptr_t
+            GetPosition() const noexcept override {
+                return (intptr_t)this->uPos;
+            }
+
+            bool
+            SetPosition(
+                intptr_t            offset,
+                StreamOffsetOrigin  from = StreamOffsetOrigin::StreamStart) override
+            {
+                switch (from) {
+                case StreamOffsetOrigin::CurrentPos:
+                    offset  += (intptr_t)this->uPos;
+                    break;
+
+                case StreamOffsetOrigin::StreamStart:
+                    offset  += 0;
+                    break;
+
+                case StreamOffsetOrigin::StreamEnd:
+                    offset  += (intptr_t)this->uSize;
+                    break;
+                }
+
+                if (offset < 0 || offset > (intptr_t)this->uSize)
+                    return false;
+
+                this->uPos  = (size_t)offset;
+                this->bEOF  = false;
+                return true;
+            }
+
+            [[nodiscard]] std::span<std::byte>
+            Buffer() const noexcept {
+                return { this->lpData, this->uSize };
+            }
+
+            bool
+            Advise(AccessHint hint, uint64_t uOffset = 0, uint64_t uLength = 0) const noexcept {
+                return AdviseMapping(this->lpData, this->uMapped, hint, uOffset, uLength);
+            }
+
+        protected:
+            std::optional<std::byte>
+            Read() noexcept {
+                if (this->uPos == this->uSize) {
+                    this->bEOF  = true;
+                    return std::nullopt;
+                }
+
+                return this->lpData[this->uPos++];
+            }
+
+            size_t
+            ReadSome(std::span<std::byte> buffer) noexcept {
+                size_t
+                    uCount  = std::min(buffer.size(), this->uSize - this->uPos);
+                if (uCount != 0)
+                    memcpy(buffer.data(), this->lpData + this->uPos, uCount);
+                if (uCount != buffer.size())
+                    this->bEOF  = true;
+
+                this->uPos  += uCount;
+                return uCount;
+            }
+
+            bool
+            PutBack(std::byte c) noexcept {
+                if (this->uPos == 0 || this->lpData[this->uPos - 1] != c)
+                    return false;
+
+                this->uPos  -= 1;
+                this->bEOF  = false;
+                return true;
+            }
+
+            std::span<const std::byte>
+            BorrowRead() const noexcept {
+                return { this->lpData + this->uPos, this->uSize - this->uPos };
+            }
+
+            void
+            Consume(size_t uCount) noexcept {
+                this->uPos  += uCount;
+            }
+
+            bool
+            Write(std::byte c) noexcept {
+                if (!this->Reserve(this->uPos + 1))
+                    return false;
+
+                this->lpData[this->uPos++] = c;
+                this->uSize = std::max(this->uSize, this->uPos);
+                return true;
+            }
+
+            size_t
+            WriteSome(std::span<const std::byte> buffer) noexcept {
+                if (buffer.empty() || !this->Reserve(this->uPos + buffer.size()))
+                    return 0;
+
+                memcpy(this->lpData + this->uPos, buffer.data(), buffer.size());
+                this->uPos  += buffer.size();
+                this->uSize = std::max(this->uSize, this->uPos);
+                return buffer.size();
+            }
+
+            std::span<std::byte>
+            BorrowWrite(size_t uMinSize) noexcept {
+                if (!this->Reserve(this->uPos + std::max<size_t>(uMinSize, 1)))
+                    return {};
+
+                return { this->lpData + this->uPos, this->uCapacity - this->uPos };
+            }
+
+            void
+            Commit(size_t uCount) noexcept {
+                this->uPos  += uCount;
+                this->uSize = std::max(this->uSize, this->uPos);
+            }
+
+            size_t
+            ReadAt(uint64_t uOffset, std::span<std::byte> buffer) const noexcept {
+                if (uOffset >= this->uSize)
+                    return 0;
+
+                size_t
+                    uCount  = std::min(buffer.size(), this->uSize - (size_t)uOffset);
+                memcpy(buffer.data(), this->lpData + uOffset, uCount);
+                return uCount;
+            }
+
+            size_t
+            WriteAt(uint64_t uOffset, std::span<const std::byte> buffer) const noexcept {
+                if (uOffset >= this->uSize)
+                    return 0;
+
+                size_t
+                    uCount  = std::min(buffer.size(), this->uSize - (size_t)uOffset);
+                memcpy(this->lpData + uOffset, buffer.data(), uCount);
+                return uCount;
+            }
+
+        private:
+            bool
+            Reserve(size_t uNeeded) noexcept {
+                if (uNeeded <= this->uCapacity)
+                    return true;
+
+                size_t
+                    uPage       = (size_t)sysconf(_SC_PAGESIZE),
+                    uNewSize    = std::max({ uNeeded, this->uCapacity * 2, uMinGrowth });
+                uNewSize    = (uNewSize + uPage - 1) / uPage * uPage;
+
+#if defined(__linux__)
+                if (fallocate(this->fd, 0, (off_t)this->uCapacity, (off_t)(uNewSize - this->uCapacity)) != 0 &&
+                    (errno == ENOSPC || ftruncate(this->fd, (off_t)uNewSize) != 0))
+#else
+                if (ftruncate(this->fd, (off_t)uNewSize) != 0)
+#endif
+                {
+                    this->bErr  = true;
+                    return false;
+                }
+
+                this->uCapacity = uNewSize;
+                if (uNewSize > this->uMapped && !this->Remap(uNewSize)) {
+                    this->bErr  = true;
+                    return false;
+                }
+
+                return true;
+            }
+
+            bool
+            Remap(size_t uNewSize) noexcept {
+                void*
+                    lpMapping   = MAP_FAILED;
+#if defined(__linux__)
+                if (this->lpData != nullptr)
+                    lpMapping   = mremap(this->lpData, this->uMapped, uNewSize, MREMAP_MAYMOVE);
+                else
+                    lpMapping   = mmap(nullptr, uNewSize, PROT_READ | PROT_WRITE, MAP_SHARED, this->fd, 0);
+#else
+                if (this->lpData != nullptr) {
+                    munmap(this->lpData, this->uMapped);
+                    this->lpData    = nullptr;
+                    this->uMapped   = 0;
+                }
+                lpMapping   = mmap(nullptr, uNewSize, PROT_READ | PROT_WRITE, MAP_SHARED, this->fd, 0);
+#endif
+
+                if (lpMapping == MAP_FAILED)
+                    return false;
+
+                this->lpData    = (std::byte*)lpMapping;
+                this->uMapped   = uNewSize;
+                return true;
+            }
+
+            int
+                fd          = -1;
+            MapSync
+                sync;
+            std::byte*
+                lpData      = nullptr;
+            size_t
+                uSize       = 0,
+                uCapacity   = 0,
+                uMapped     = 0,
+                uPos        = 0;
+            bool
+                bEOF        = false,
+                bErr        = false;
+        };
+    }
+
+    class MappedIFileStream final :
+        public  __impl::ReadOnlyFileMapping,
+        public  IStream,
+        public  __impl::SpanStreamBase<const std::byte> {
+    public:
+        MappedIFileStream(
+            std::string_view    strvFilename,
+            AccessHint          hint        = AccessHint::Normal,
+            bool                bPopulate   = false) :
+            ReadOnlyFileMapping(strvFilename, hint, bPopulate),
+            SpanStreamBase(this->ReadOnlyFileMapping::Mapping()) {}
+
+        std::optional<std::byte>
+        Read() override {
+            return this->SpanStreamBase::Read();
+        }
+
+        size_t
+        ReadSome(std::span<std::byte> buffer) override {
+            return this->SpanStreamBase::ReadSome(buffer);
+        }
+
+        bool
+        PutBack(std::byte c) override {
+            return this->SpanStreamBase::PutBack(c);
+        }
+
+        std::span<const std::byte>
+        BorrowRead() override {
+            return this->SpanStreamBase::BorrowRead();
+        }
+
+        void
+        Consume(size_t uCount) override {
+            this->SpanStreamBase::Consume(uCount);
+        }
+
+        size_t
+        ReadAt(uint64_t uOffset, std::span<std::byte> buffer) override {
+            return this->SpanStreamBase::ReadAt(uOffset, buffer);
+        }
+    };
+
+    class MappedOFileStream final :
+        public  OStream,
+        public  __impl::WritableFileMapping {
+    public:
+        MappedOFileStream(std::string_view strvFilename, MapSync sync = MapSync::Async) :
+            WritableFileMapping(strvFilename, O_TRUNC, sync) {}
+
+        bool
+        Write(std::byte c) override {
+            return this->WritableFileMapping::Write(c);
+        }
+
+        size_t
+        WriteSome(std::span<const std::byte> buffer) override {
+            return this->WritableFileMapping::WriteSome(buffer);
+        }
+
+        std::span<std::byte>
+        BorrowWrite(size_t uMinSize) override {
+            return this->WritableFileMapping::BorrowWrite(uMinSize);
+        }
+
+        void
+        Commit(size_t uCount) override {
+            this->WritableFileMapping::Commit(uCount);
+        }
+
+        size_t
+        WriteAt(uint64_t uOffset, std::span<const std::byte> buffer) override {
+            return this->WritableFileMapping::WriteAt(uOffset, buffer);
+        }
+    };
+
+    class MappedIOFileStream final :
+        public  IOStream,
+        public  __impl::WritableFileMapping {
+    public:
+        MappedIOFileStream(std::string_view strvFilename, MapSync sync = MapSync::Async) :
+            WritableFileMapping(strvFilename, 0, sync) {}
+
+        std::optional<std::byte>
+        Read() override {
+            return this->WritableFileMapping::Read();
+        }
+
+        size_t
+        ReadSome(std::span<std::byte> buffer) override {
+            return this->WritableFileMapping::ReadSome(buffer);
+        }
+
+        bool
+        PutBack(std::byte c) override {
+            return this->WritableFileMapping::PutBack(c);
+        }
+
+        std::span<const std::byte>
+        BorrowRead() override {
+            return this->WritableFileMapping::BorrowRead();
+        }
+
+        void
+        Consume(size_t uCount) override {
+            this->WritableFileMapping::Consume(uCount);
+        }
+
+        bool
+        Write(std::byte c) override {
+            return this->WritableFileMapping::Write(c);
+        }
+
+        size_t
+        WriteSome(std::span<const std::byte> buffer) override {
+            return this->WritableFileMapping::WriteSome(buffer);
+        }
+
+        std::span<std::byte>
+        BorrowWrite(size_t uMinSize) override {
+            return this->WritableFileMapping::BorrowWrite(uMinSize);
+        }
+
+        void
+        Commit(size_t uCount) override {
+            this->WritableFileMapping::Commit(uCount);
+        }
+
+        size_t
+        ReadAt(uint64_t uOffset, std::span<std::byte> buffer) override {
+            return this->WritableFileMapping::ReadAt(uOffset, buffer);
+        }
+
+        size_t
+        WriteAt(uint64_t uOffset, std::span<const std::byte> buffer) override {
+            return this->WritableFileMapping::WriteAt(uOffset, buffer);
+        }
+    };
+}
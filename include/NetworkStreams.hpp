@@ -1,19 +1,158 @@
 #pragma once
 #include "IOStreams.hpp"
+#include "DescriptorIO.hpp"
 
 #include <string_view>
 #include <stdexcept>
 #include <optional>
+#include <new>
+#include <bit>
+#include <mutex>
+#include <tuple>
+#include <cerrno>
+#include <cstring>
+#include <algorithm>
 
 #include <netinet/in.h>                                                                                          
 #include <sys/unistd.h>                                                                                          
 #include <sys/socket.h>                                                                                          
 #include <arpa/inet.h>                                                                                           
 #include <sys/un.h>
+#include <sys/uio.h>
 #include <netdb.h>
 
 
 namespace io {
+    // recycles connection objects and their buffers in power-of-two size
+    // classes, so connection churn stays off the global allocator. blocks
+    // beyond uMaxCached per class go back to it
+    class NetworkBufferPool {
+    public:
+        NetworkBufferPool(size_t uMaxCached = 1024) :
+            uMaxCached(uMaxCached) {}
+
+        NetworkBufferPool(const NetworkBufferPool&) = delete;
+        NetworkBufferPool&
+        operator=(const NetworkBufferPool&) = delete;
+
+        ~NetworkBufferPool() noexcept {
+            for (SizeClass& sizeClass : this->lpClasses) {
+                while (sizeClass.lpHead != nullptr) {
+                    Node*
+                        lpNode  = sizeClass.lpHead;
+                    sizeClass.lpHead    = lpNode->lpNext;
+                    ::operator delete(lpNode);
+                }
+            }
+        }
+
+        // never destroyed: streams may outlive every static object
+        static NetworkBufferPool&
+        Default() {
+            static NetworkBufferPool*
+                lpPool  = new NetworkBufferPool();
+            return *lpPool;
+        }
+
+        [[nodiscard]] static size_t
+        Capacity(size_t uSize) noexcept {
+            return (size_t)1 << ClassOf(uSize);
+        }
+
+        [[nodiscard]] void*
+        Acquire(size_t uSize) noexcept {
+            size_t
+                uClass  = ClassOf(uSize);
+            SizeClass&
+                sizeClass   = this->lpClasses[uClass];
+            {
+                std::lock_guard
+                    lock(sizeClass.mtx);
+                if (sizeClass.lpHead != nullptr) {
+                    Node*
+                        lpNode  = sizeClass.lpHead;
+                    sizeClass.lpHead    = lpNode->lpNext;
+                    sizeClass.uCount    -= 1;
+                    return lpNode;
+                }
+            }
+
+            return ::operator new((size_t)1 << uClass, std::nothrow);
+        }
+
+        void
+        Release(void* lpBlock, size_t uSize) noexcept {
+            if (lpBlock == nullptr)
+                return;
+
+            SizeClass&
+                sizeClass   = this->lpClasses[ClassOf(uSize)];
+            {
+                std::lock_guard
+                    lock(sizeClass.mtx);
+                if (sizeClass.uCount < this->uMaxCached) {
+                    sizeClass.lpHead    = new (lpBlock) Node{ sizeClass.lpHead };
+                    sizeClass.uCount    += 1;
+                    return;
+                }
+            }
+
+            ::operator delete(lpBlock);
+        }
+
+    private:
+        static constexpr size_t
+            uMinClass   = 6,
+            uClasses    = sizeof(size_t) * 8;
+
+        static size_t
+        ClassOf(size_t uSize) noexcept {
+            return std::max<size_t>((size_t)std::bit_width(std::max<size_t>(uSize, 1) - 1), uMinClass);
+        }
+
+        struct Node {
+            Node*
+                lpNext  = nullptr;
+        };
+
+        struct SizeClass {
+            std::mutex
+                mtx;
+            Node*
+                lpHead  = nullptr;
+            size_t
+                uCount  = 0;
+        };
+
+        size_t
+            uMaxCached  = 0;
+        SizeClass
+            lpClasses[uClasses];
+    };
+
+    struct NetworkBuffers {
+        static constexpr size_t
+            uDefaultSize    = sizeof(size_t) * 1024;
+
+        size_t
+            uInputSize      = uDefaultSize,
+            uOutputSize     = uDefaultSize;
+        int
+            iRecvBuf        = 0,    // SO_RCVBUF, 0 keeps the kernel's choice
+            iSendBuf        = 0;    // SO_SNDBUF, likewise
+        // let each buffer grow while transfers fill it and shrink back while
+        // they keep leaving it mostly unused, within [uMinSize, uMaxSize]
+        bool
+            bAdaptive       = false;
+        size_t
+            uMinSize        = 1024,
+            uMaxSize        = 1024 * 1024;
+        // where connections and their buffers come from, nullptr meaning
+        // NetworkBufferPool::Default()
+        NetworkBufferPool*
+            lpPool          = nullptr;
+    };
+
     namespace __impl {
         class BufferedNetworkStream {
         public:
@@ -31,23 +170,61 @@ namespace io {
             BufferedNetworkStream&
             operator=(BufferedNetworkStream&&) noexcept = delete;
 
-            BufferedNetworkStream(int fdSocket) {
+            // connections come from the pool as well; the stream remembers
+            // which one so that delete can hand it back
+            static void*
+            operator new(size_t uSize, NetworkBufferPool& pool) {
+                void*
+                    lpBlock = pool.Acquire(uSize);
+                if (lpBlock == nullptr)
+                    throw std::bad_alloc();
+                return lpBlock;
+            }
+
+            static void
+            operator delete(void* lpBlock, NetworkBufferPool& pool) noexcept {
+                pool.Release(lpBlock, sizeof(BufferedNetworkStream));
+            }
+
+            static void
+            operator delete(BufferedNetworkStream* lpStream, std::destroying_delete_t) noexcept {
+                NetworkBufferPool&
+                    pool    = *lpStream->lpPool;
+                lpStream->~BufferedNetworkStream();
+                pool.Release(lpStream, sizeof(BufferedNetworkStream));
+            }
+
+            BufferedNetworkStream(int fdSocket, const NetworkBuffers& buffers = {}) :
+                config(buffers),
+                lpPool((buffers.lpPool != nullptr) ? buffers.lpPool : &NetworkBufferPool::Default())
+            {
                 if (fdSocket < 0)
                     throw std::runtime_error("failed to create a socket");
 
-                this->i.lpData      = new std::byte[this->i.uBufCap];
-                this->o.lpData      = new std::byte[this->o.uBufCap];
+                if (this->config.iRecvBuf > 0)
+                    setsockopt(fdSocket, SOL_SOCKET, SO_RCVBUF, &this->config.iRecvBuf, sizeof(int));
+                if (this->config.iSendBuf > 0)
+                    setsockopt(fdSocket, SOL_SOCKET, SO_SNDBUF, &this->config.iSendBuf, sizeof(int));
+
+                // buffers are only taken from the pool on the first I/O in
+                // their direction, so one-way and idle streams hold none
+                this->i.uBufCap     = NetworkBufferPool::Capacity(this->config.uInputSize);
+                this->o.uBufCap     = NetworkBufferPool::Capacity(this->config.uOutputSize);
                 this->s.fdSocket    = fdSocket;
             }
 
             ~BufferedNetworkStream() noexcept {
                 this->Flush();
                 shutdown(this->s.fdSocket, SHUT_RD);
-                while (this->GetInput()) {}
+
+                std::byte
+                    lpDrain[256];
+                while (recv(this->s.fdSocket, lpDrain, sizeof(lpDrain), 0) > 0) {}
+
                 shutdown(this->s.fdSocket, SHUT_RDWR);
                 close(this->s.fdSocket);
-                delete[] this->i.lpData;
-                delete[] this->o.lpData;
+                this->lpPool->Release(this->i.lpData, this->i.uBufCap);
+                this->lpPool->Release(this->o.lpData, this->o.uBufCap);
             }
 
             std::optional<std::byte>
@@ -65,6 +242,10 @@ namespace io {
 
             bool
             Write(std::byte c) noexcept {
+                this->s.bAgain  = false;
+                if (this->o.lpData == nullptr && !this->Allocate(this->o.lpData, this->o.uBufCap))
+                    return false;
+
                 if (this->o.uSize == this->o.uBufCap) {
                     if (!this->Flush())
                         return false;
@@ -76,26 +257,196 @@ namespace io {
 
             size_t
             ReadSome(std::span<std::byte> buffer) noexcept {
-                for (size_t i = 0; i != buffer.size(); ++i) {
-                    std::optional<std::byte>
-                        optc    = this->Read();
-                    if (!optc)
-                        return i;
+                this->s.bAgain  = false;
+                size_t
+                    uRead   = this->TakeBuffered(buffer);
+                while (uRead != buffer.size()) {
+                    std::span<std::byte>
+                        rest    = buffer.subspan(uRead);
+                    if (rest.size() < this->i.uBufCap) {
+                        if (!this->GetInput())
+                            break;
+                        uRead   += this->TakeBuffered(rest);
+                        continue;
+                    }
+
+                    // large reads skip the staging buffer altogether
+                    ssize_t
+                        iInputSize  = recv(
+                                        this->s.fdSocket,
+                                        rest.data(),
+                                        rest.size(),
+                                        0);
+                    if (iInputSize < 0) {
+                        this->Fail();
+                        break;
+                    }
+
+                    if (iInputSize == 0) {
+                        this->s.bEOF = true;
+                        break;
+                    }
+
+                    uRead   += (size_t)iInputSize;
                 }
 
-                return buffer.size();
+                return uRead;
             }
 
             size_t
             WriteSome(std::span<const std::byte> buffer) noexcept {
-                for (size_t i = 0; i != buffer.size(); ++i) {
-                    if (!this->Write(buffer[i]))
-                        return i;
+                this->s.bAgain  = false;
+                if (buffer.size() > this->o.uBufCap - this->o.uSize) {
+                    if (!this->Flush())
+                        return 0;
+
+                    if (buffer.size() >= this->o.uBufCap)
+                        return this->SendAll(buffer);
                 }
 
+                if (this->o.lpData == nullptr && !this->Allocate(this->o.lpData, this->o.uBufCap))
+                    return 0;
+
+                memcpy(this->o.lpData + this->o.uSize, buffer.data(), buffer.size());
+                this->o.uSize   += buffer.size();
                 return buffer.size();
             }
 
+            size_t
+            ReadSomeV(std::span<const std::span<std::byte>> buffers) noexcept {
+                this->s.bAgain  = false;
+                size_t
+                    uTotal  = 0,
+                    uIndex  = 0,
+                    uOffset = 0;
+                while (uIndex != buffers.size()) {
+                    std::span<std::byte>
+                        buffer  = buffers[uIndex].subspan(uOffset);
+                    size_t
+                        uCopied = this->TakeBuffered(buffer);
+                    uTotal  += uCopied;
+                    AdvanceCursor(buffers, uIndex, uOffset, uCopied);
+                    if (uCopied != buffer.size())
+                        break;
+                }
+
+                if (uIndex != buffers.size() &&
+                    this->i.lpData == nullptr && !this->Allocate(this->i.lpData, this->i.uBufCap))
+                    return uTotal;
+
+                while (uIndex != buffers.size()) {
+                    struct iovec
+                        lpVec[uMaxVec];
+                    size_t
+                        uVecs   = 0,
+                        uWanted = 0,
+                        j       = uIndex;
+                    for (; j != buffers.size() && uVecs != uMaxVec - 1; ++j) {
+                        std::span<std::byte>
+                            buffer  = buffers[j].subspan((j == uIndex) ? uOffset : 0);
+                        lpVec[uVecs++]  = { buffer.data(), buffer.size() };
+                        uWanted         += buffer.size();
+                    }
+                    // only the last batch may spill into the buffer, a later
+                    // readv would overwrite it with bytes that come after
+                    if (j == buffers.size())
+                        lpVec[uVecs++]  = { this->i.lpData, this->i.uBufCap };
+
+                    ssize_t
+                        iInputSize  = readv(this->s.fdSocket, lpVec, (int)uVecs);
+                    if (iInputSize < 0) {
+                        this->Fail();
+                        break;
+                    }
+
+                    if (iInputSize == 0) {
+                        this->s.bEOF = true;
+                        break;
+                    }
+
+                    size_t
+                        uRead   = (size_t)iInputSize;
+                    if (uRead > uWanted) {
+                        this->i.uBegin  = 0;
+                        this->i.uEnd    = uRead - uWanted;
+                        uRead           = uWanted;
+                    }
+
+                    uTotal  += uRead;
+                    AdvanceCursor(buffers, uIndex, uOffset, uRead);
+                }
+
+                return uTotal;
+            }
+
+            size_t
+            WriteSomeV(std::span<const std::span<const std::byte>> buffers) noexcept {
+                this->s.bAgain  = false;
+                size_t
+                    uTotal  = 0;
+                for (std::span<const std::byte> buffer : buffers)
+                    uTotal  += buffer.size();
+
+                if (uTotal <= this->o.uBufCap - this->o.uSize) {
+                    if (this->o.lpData == nullptr && !this->Allocate(this->o.lpData, this->o.uBufCap))
+                        return 0;
+
+                    for (std::span<const std::byte> buffer : buffers) {
+                        if (!buffer.empty())
+                            memcpy(this->o.lpData + this->o.uSize, buffer.data(), buffer.size());
+                        this->o.uSize   += buffer.size();
+                    }
+
+                    return uTotal;
+                }
+
+                size_t
+                    uWritten    = 0,
+                    uStaged     = 0,
+                    uIndex      = 0,
+                    uOffset     = 0;
+                while (uStaged != this->o.uSize || uIndex != buffers.size()) {
+                    struct iovec
+                        lpVec[uMaxVec];
+                    size_t
+                        uVecs   = 0;
+                    if (uStaged != this->o.uSize)
+                        lpVec[uVecs++]  = { this->o.lpData + uStaged, this->o.uSize - uStaged };
+                    for (size_t j = uIndex; j != buffers.size() && uVecs != uMaxVec; ++j) {
+                        std::span<const std::byte>
+                            buffer  = buffers[j].subspan((j == uIndex) ? uOffset : 0);
+                        lpVec[uVecs++]  = { (void*)buffer.data(), buffer.size() };
+                    }
+
+                    struct msghdr
+                        msg     = {};
+                    msg.msg_iov     = lpVec;
+                    msg.msg_iovlen  = uVecs;
+
+                    ssize_t
+                        iOutputSize = sendmsg(this->s.fdSocket, &msg, MSG_NOSIGNAL);
+                    if (iOutputSize < 0) {
+                        this->Fail();
+                        break;
+                    }
+
+                    size_t
+                        uSent       = (size_t)iOutputSize,
+                        uFlushed    = std::min(uSent, this->o.uSize - uStaged);
+                    uStaged     += uFlushed;
+                    uSent       -= uFlushed;
+                    uWritten    += uSent;
+                    AdvanceCursor(buffers, uIndex, uOffset, uSent);
+                }
+
+                if (uStaged != 0) {
+                    memmove(this->o.lpData, this->o.lpData + uStaged, this->o.uSize - uStaged);
+                    this->o.uSize   -= uStaged;
+                }
+
+                return uWritten;
+            }
+
             bool
             PutBack(std::byte c) noexcept {
                 if (this->s.uRetLen == sizeof(this->s.lpRetBuf))
@@ -105,22 +456,66 @@ namespace io {
                 return true;
             }
 
+            std::span<const std::byte>
+            BorrowRead() noexcept {
+                if (this->s.uRetLen != 0)
+                    return {};
+
+                if (this->i.uBegin == this->i.uEnd) {
+                    if (!this->GetInput())
+                        return {};
+                }
+
+                return {
+                    this->i.lpData + this->i.uBegin,
+                    this->i.uEnd - this->i.uBegin };
+            }
+
+            void
+            Consume(size_t uCount) noexcept {
+                this->i.uBegin  += uCount;
+            }
+
+            std::span<std::byte>
+            BorrowWrite(size_t uMinSize) noexcept {
+                this->s.bAgain  = false;
+                if (uMinSize > this->o.uBufCap)
+                    return {};
+
+                if (this->o.lpData == nullptr && !this->Allocate(this->o.lpData, this->o.uBufCap))
+                    return {};
+
+                // flushing may also shrink an adaptive buffer below uMinSize
+                if (this->o.uBufCap - this->o.uSize < uMinSize) {
+                    if (!this->Flush() || this->o.uBufCap - this->o.uSize < uMinSize)
+                        return {};
+                }
+
+                return {
+                    this->o.lpData + this->o.uSize,
+                    this->o.uBufCap - this->o.uSize };
+            }
+
+            void
+            Commit(size_t uCount) noexcept {
+                this->o.uSize   += uCount;
+            }
+
             bool
             Flush() noexcept {
+                this->s.bAgain  = false;
                 if (this->o.uSize == 0)
                     return true;
 
-                ssize_t
-                    iOutputSize = send(
-                                    this->s.fdSocket,
-                                    this->o.lpData,
-                                    this->o.uSize,
-                                    0);
-                if (iOutputSize < 0) {
-                    this->s.bErr = true;
+                size_t
+                    uSent   = this->SendAll({ this->o.lpData, this->o.uSize });
+                if (uSent != this->o.uSize) {
+                    memmove(this->o.lpData, this->o.lpData + uSent, this->o.uSize - uSent);
+                    this->o.uSize   -= uSent;
                     return false;
                 }
 
+                this->Adapt(this->o.lpData, this->o.uBufCap, this->o.uIdle, uSent);
                 this->o.uSize   = 0;
                 return true;
             }
@@ -129,6 +524,7 @@ namespace io {
             ClearFlags() noexcept {
                 this->s.bEOF    = false;
                 this->s.bErr    = false;
+                this->s.bAgain  = false;
             }
 
             bool
@@ -138,7 +534,7 @@ namespace io {
 
             bool
             Error() const noexcept {
-                return (bool)this->s.bEOF;
+                return this->s.bEOF || this->s.bErr;
             }
 
             int
@@ -146,9 +542,233 @@ namespace io {
                 return this->s.fdSocket;
             }
 
+            [[nodiscard]] size_t
+            InputCapacity() const noexcept {
+                return this->i.uBufCap;
+            }
+
+            [[nodiscard]] size_t
+            OutputCapacity() const noexcept {
+                return this->o.uBufCap;
+            }
+
+            // true when the last socket call on a non-blocking descriptor
+            // found nothing to read or no room to write
+            bool
+            WouldBlock() const noexcept {
+                return (bool)this->s.bAgain;
+            }
+
+            [[nodiscard]] size_t
+            BufferedInput() const noexcept {
+                return this->s.uRetLen + this->i.uEnd - this->i.uBegin;
+            }
+
+            [[nodiscard]] size_t
+            PendingOutput() const noexcept {
+                return this->o.uSize;
+            }
+
+            // refill for event loops: keeps unread input, moving it to the
+            // front, and receives once into the rest of the buffer, which
+            // grows when that input fills it. false on end of stream, error
+            // or WouldBlock(); input that won't fit in uMaxSize is an error
+            bool
+            Receive() noexcept {
+                this->s.bAgain  = false;
+                if (this->i.lpData == nullptr && !this->Allocate(this->i.lpData, this->i.uBufCap))
+                    return false;
+
+                if (this->i.uBegin != 0) {
+                    memmove(this->i.lpData, this->i.lpData + this->i.uBegin, this->i.uEnd - this->i.uBegin);
+                    this->i.uEnd    -= this->i.uBegin;
+                    this->i.uBegin  = 0;
+                }
+                if (this->i.uEnd == this->i.uBufCap && !this->Grow()) {
+                    this->s.bErr    = true;
+                    return false;
+                }
+
+                ssize_t
+                    iInputSize  = recv(
+                                    this->s.fdSocket,
+                                    this->i.lpData + this->i.uEnd,
+                                    this->i.uBufCap - this->i.uEnd,
+                                    0);
+                if (iInputSize < 0) {
+                    this->Fail();
+                    return false;
+                }
+
+                if (iInputSize == 0) {
+                    this->s.bEOF = true;
+                    return false;
+                }
+
+                this->i.uEnd    += (size_t)iInputSize;
+                this->Adapt(this->i.lpData, this->i.uBufCap, this->i.uIdle, this->i.uEnd, this->i.uEnd);
+                return true;
+            }
+
+            // hands buffers with nothing in them back to the pool, so idle
+            // connections hold none; the next I/O takes a fresh one at the
+            // configured size
+            void
+            Trim() noexcept {
+                if (this->i.lpData != nullptr && this->i.uBegin == this->i.uEnd) {
+                    this->lpPool->Release(this->i.lpData, this->i.uBufCap);
+                    this->i.lpData  = nullptr;
+                    this->i.uBufCap = NetworkBufferPool::Capacity(this->config.uInputSize);
+                    this->i.uBegin  = 0;
+                    this->i.uEnd    = 0;
+                    this->i.uIdle   = 0;
+                }
+
+                if (this->o.lpData != nullptr && this->o.uSize == 0) {
+                    this->lpPool->Release(this->o.lpData, this->o.uBufCap);
+                    this->o.lpData  = nullptr;
+                    this->o.uBufCap = NetworkBufferPool::Capacity(this->config.uOutputSize);
+                    this->o.uIdle   = 0;
+                }
+            }
+
+            bool
+            HasBuffered() const noexcept {
+                return this->s.uRetLen != 0
+                    || this->i.uBegin != this->i.uEnd
+                    || this->o.uSize != 0;
+            }
+
         private:
+            static constexpr size_t
+                uMaxVec         = 64,
+                uShrinkAfter    = 16;
+
+            size_t
+            TakeBuffered(std::span<std::byte> buffer) noexcept {
+                size_t
+                    uCopied = 0;
+                while (this->s.uRetLen != 0 && uCopied != buffer.size())
+                    buffer[uCopied++] = this->s.lpRetBuf[--this->s.uRetLen];
+
+                size_t
+                    uCount  = std::min(buffer.size() - uCopied, this->i.uEnd - this->i.uBegin);
+                if (uCount != 0)
+                    memcpy(buffer.data() + uCopied, this->i.lpData + this->i.uBegin, uCount);
+                this->i.uBegin  += uCount;
+                return uCopied + uCount;
+            }
+
+            // a non-blocking socket running dry isn't an error, just noted
+            void
+            Fail() noexcept {
+                if (errno == EAGAIN || errno == EWOULDBLOCK)
+                    this->s.bAgain  = true;
+                else
+                    this->s.bErr    = true;
+            }
+
+            bool
+            Allocate(std::byte*& lpData, size_t uBufCap) noexcept {
+                lpData  = (std::byte*)this->lpPool->Acquire(uBufCap);
+                if (lpData == nullptr)
+                    this->s.bErr    = true;
+                return lpData != nullptr;
+            }
+
+            // called after a transfer that left uUsed bytes of the buffer in
+            // use: a full one doubles it, a run of mostly unused ones halves
+            // it. the first uKeep bytes move over to the new buffer
+            void
+            Adapt(std::byte*& lpData, size_t& uBufCap, size_t& uIdle, size_t uUsed, size_t uKeep = 0) noexcept {
+                if (!this->config.bAdaptive || lpData == nullptr)
+                    return;
+
+                size_t
+                    uNewCap = uBufCap;
+                if (uUsed == uBufCap) {
+                    uIdle   = 0;
+                    uNewCap = std::min(uBufCap * 2, std::max(this->config.uMaxSize, uBufCap));
+                } else if (uUsed < uBufCap / 4 && ++uIdle == uShrinkAfter) {
+                    uIdle   = 0;
+                    uNewCap = std::max(uBufCap / 2, std::min(this->config.uMinSize, uBufCap));
+                } else if (uUsed >= uBufCap / 4) {
+                    uIdle   = 0;
+                }
+
+                if (uNewCap == uBufCap)
+                    return;
+
+                uNewCap = NetworkBufferPool::Capacity(uNewCap);
+                if (uNewCap == uBufCap)
+                    return;
+
+                std::byte*
+                    lpNewData   = (std::byte*)this->lpPool->Acquire(uNewCap);
+                if (lpNewData == nullptr)
+                    return;
+
+                if (uKeep != 0)
+                    memcpy(lpNewData, lpData, uKeep);
+                this->lpPool->Release(lpData, uBufCap);
+                lpData  = lpNewData;
+                uBufCap = uNewCap;
+            }
+
+            // doubles an input buffer that's full of unconsumed bytes, up to
+            // uMaxSize, whether or not the buffers adapt
+            bool
+            Grow() noexcept {
+                if (this->i.uBufCap >= this->config.uMaxSize)
+                    return false;
+
+                size_t
+                    uNewCap     = NetworkBufferPool::Capacity(std::min(this->i.uBufCap * 2, this->config.uMaxSize));
+                std::byte*
+                    lpNewData   = (std::byte*)this->lpPool->Acquire(uNewCap);
+                if (lpNewData == nullptr)
+                    return false;
+
+                memcpy(lpNewData, this->i.lpData, this->i.uEnd);
+                this->lpPool->Release(this->i.lpData, this->i.uBufCap);
+                this->i.lpData  = lpNewData;
+                this->i.uBufCap = uNewCap;
+                this->i.uIdle   = 0;
+                return true;
+            }
+
+            // send() may take only part of the span, so keep going until
+            // everything is out or the socket fails. a peer that went away
+            // shows up as EPIPE rather than a SIGPIPE killing the process
+            size_t
+            SendAll(std::span<const std::byte> buffer) noexcept {
+                this->s.bAgain  = false;
+                size_t
+                    uSent   = 0;
+                while (uSent != buffer.size()) {
+                    ssize_t
+                        iOutputSize = send(
+                                        this->s.fdSocket,
+                                        buffer.data() + uSent,
+                                        buffer.size() - uSent,
+                                        MSG_NOSIGNAL);
+                    if (iOutputSize < 0) {
+                        this->Fail();
+                        break;
+                    }
+
+                    uSent   += (size_t)iOutputSize;
+                }
+
+                return uSent;
+            }
+
             bool
             GetInput() {
+                this->s.bAgain  = false;
+                if (this->i.lpData == nullptr && !this->Allocate(this->i.lpData, this->i.uBufCap))
+                    return false;
+
                 ssize_t
                     iInputSize  = recv(
                                     this->s.fdSocket,
@@ -156,7 +776,7 @@ namespace io {
                                     this->i.uBufCap,
                                     0);
                 if (iInputSize < 0) {
-                    this->s.bErr = true;
+                    this->Fail();
                     return false;
                 }
 
@@ -167,26 +787,32 @@ namespace io {
 
                 this->i.uBegin  = 0;
                 this->i.uEnd    = (size_t)iInputSize;
+                this->Adapt(this->i.lpData, this->i.uBufCap, this->i.uIdle, this->i.uEnd, this->i.uEnd);
                 return true;
             }
 
+            NetworkBuffers
+                config;
+            NetworkBufferPool*
+                lpPool      = nullptr;
+
             struct InputBuffer {
-                static constexpr size_t
-                    uBufCap     = sizeof(size_t) * 1024;
                 std::byte*
                     lpData      = nullptr;
                 size_t
+                    uBufCap     = 0,
                     uBegin      = 0,
-                    uEnd        = 0;
+                    uEnd        = 0,
+                    uIdle       = 0;
             } i;
 
             struct OutputBuffer {
-                static constexpr size_t
-                    uBufCap     = sizeof(size_t) * 1024;
                 std::byte*
                     lpData      = nullptr;
                 size_t
-                    uSize       = 0;
+                    uBufCap     = 0,
+                    uSize       = 0,
+                    uIdle       = 0;
             } o;
             
             struct State {
@@ -195,7 +821,8 @@ namespace io {
                 uint8_t
                     bEOF    : 1 = false,
                     bErr    : 1 = false,
-                    uRetLen : 6 = 0;
+                    bAgain  : 1 = false,
+                    uRetLen : 5 = 0;
                 std::byte
                     lpRetBuf[sizeof(int) - 1];
             } s;
@@ -227,6 +854,13 @@ namespace io {
             ClearFlags() noexcept override {
                 return this->hStream->ClearFlags();
             }
+
+            [[nodiscard]] int
+            TransferDescriptor() const noexcept override {
+                if (this->hStream == nullptr || this->hStream->HasBuffered())
+                    return -1;
+                return this->hStream->Descriptor();
+            }
         
             BufferedNetworkStream*
             Handle() const noexcept {
@@ -241,8 +875,9 @@ namespace io {
         class NetworkStreamBase :
             public NetworkStreamViewBase {
         public:
-            NetworkStreamBase(int fdSocket) :
-                NetworkStreamViewBase(new BufferedNetworkStream(fdSocket)) {}
+            NetworkStreamBase(int fdSocket, const NetworkBuffers& buffers = {}) :
+                NetworkStreamViewBase(new ((buffers.lpPool != nullptr) ? *buffers.lpPool : NetworkBufferPool::Default())
+                    BufferedNetworkStream(fdSocket, buffers)) {}
 
             NetworkStreamBase(const NetworkStreamBase&) = delete;
 
@@ -281,8 +916,8 @@ namespace io {
             using ConnectionType    =
                 std::optional<StreamViewT>;
 
-            BasicClient() :
-                stream(socket(AddressT::AddressFamily, SOCK_STREAM, 0)) {}
+            BasicClient(const NetworkBuffers& buffers = {}) :
+                stream(socket(AddressT::AddressFamily, SOCK_STREAM, 0), buffers) {}
 
             ConnectionType
             Connect(const AddressT& addr) {
@@ -315,13 +950,24 @@ namespace io {
             using ConnectionType    =
                 std::optional<std::pair<StreamT, AddressT>>;
 
-            BasicServer(const AddressT& addr, int iPendingConnections = 32) :
-                fdServer(socket(AddressT::AddressFamily, SOCK_STREAM, 0))
+            BasicServer(
+                const AddressT&         addr,
+                int                     iPendingConnections = 32,
+                const NetworkBuffers&   buffers             = {}) :
+                fdServer(socket(AddressT::AddressFamily, SOCK_STREAM, 0)),
+                buffers(buffers)
             {
                 if (fdServer < 0) {
                     throw std::runtime_error("failed to create server socket");
                 }
 
+                // accepted sockets inherit these, and a receive buffer only
+                // sets the advertised window scale if it's in place before listen()
+                if (this->buffers.iRecvBuf > 0)
+                    setsockopt(this->fdServer, SOL_SOCKET, SO_RCVBUF, &this->buffers.iRecvBuf, sizeof(int));
+                if (this->buffers.iSendBuf > 0)
+                    setsockopt(this->fdServer, SOL_SOCKET, SO_SNDBUF, &this->buffers.iSendBuf, sizeof(int));
+
                 if (!addr.Bind(this->fdServer)) {
                     throw std::runtime_error("failed to bind the server socket to an address");
                 }
@@ -332,7 +978,9 @@ namespace io {
             }
 
             BasicServer(const BasicServer&) = delete;
-            BasicServer(BasicServer&& obj) noexcept {
+            BasicServer(BasicServer&& obj) noexcept :
+                buffers(obj.buffers)
+            {
                 this->fdServer  = obj.fdServer;
                 obj.fdServer    = -1;
             }
@@ -344,9 +992,15 @@ namespace io {
                 BasicServer
                     temp    = std::move(obj);
                 std::swap(this->fdServer, temp.fdServer);
+                std::swap(this->buffers, temp.buffers);
                 return *this;
             }
 
+            [[nodiscard]] int
+            Descriptor() const noexcept {
+                return this->fdServer;
+            }
+
             ConnectionType
             Accept() {
                 ConnectionType
@@ -355,13 +1009,14 @@ namespace io {
                 AddressT
                     addrAccept;
                 socklen_t
-                    uSockAddrlen;
+                    uSockAddrlen    = sizeof(AddressT);
                 int
                     fdAccept    = accept(this->fdServer, (struct sockaddr*)&addrAccept, &uSockAddrlen);
                 if (fdAccept >= 0) {
                     connection.emplace(
-                        StreamT(fdAccept),
-                        addrAccept);
+                        std::piecewise_construct,
+                        std::forward_as_tuple(fdAccept, this->buffers),
+                        std::forward_as_tuple(addrAccept));
                 }
                 
                 return connection;
@@ -377,10 +1032,12 @@ namespace io {
         private:
             int
                 fdServer = -1;
+            NetworkBuffers
+                buffers;
         };
     }
 
-    class INetworkStreamView :
+    class INetworkStreamView final :
         public SerialIStream,
         public __impl::NetworkStreamViewBase {
     public:
@@ -399,13 +1056,28 @@ namespace io {
             return this->hStream->ReadSome(buffer);
         }
 
+        size_t
+        ReadSomeV(std::span<const std::span<std::byte>> buffers) override {
+            return this->hStream->ReadSomeV(buffers);
+        }
+
         bool
         PutBack(std::byte c) override {
             return this->hStream->PutBack(c);
         }
+
+        std::span<const std::byte>
+        BorrowRead() override {
+            return this->hStream->BorrowRead();
+        }
+
+        void
+        Consume(size_t uCount) override {
+            this->hStream->Consume(uCount);
+        }
     };
 
-    class ONetworkStreamView :
+    class ONetworkStreamView final :
         public SerialOStream,
         public __impl::NetworkStreamViewBase {
     public:
@@ -423,9 +1095,24 @@ namespace io {
         WriteSome(std::span<const std::byte> buffer) override {
             return this->hStream->WriteSome(buffer);
         }
+
+        size_t
+        WriteSomeV(std::span<const std::span<const std::byte>> buffers) override {
+            return this->hStream->WriteSomeV(buffers);
+        }
+
+        std::span<std::byte>
+        BorrowWrite(size_t uMinSize) override {
+            return this->hStream->BorrowWrite(uMinSize);
+        }
+
+        void
+        Commit(size_t uCount) override {
+            this->hStream->Commit(uCount);
+        }
     };
 
-    class IONetworkStreamView :
+    class IONetworkStreamView final :
         public SerialIOStream,
         public __impl::NetworkStreamViewBase {
     public:
@@ -442,11 +1129,26 @@ namespace io {
             return this->hStream->ReadSome(buffer);
         }
 
+        size_t
+        ReadSomeV(std::span<const std::span<std::byte>> buffers) override {
+            return this->hStream->ReadSomeV(buffers);
+        }
+
         bool
         PutBack(std::byte c) override {
             return this->hStream->PutBack(c);
         }
 
+        std::span<const std::byte>
+        BorrowRead() override {
+            return this->hStream->BorrowRead();
+        }
+
+        void
+        Consume(size_t uCount) override {
+            this->hStream->Consume(uCount);
+        }
+
         bool
         Write(std::byte c) override {
             return this->hStream->Write(c);
@@ -456,14 +1158,29 @@ namespace io {
         WriteSome(std::span<const std::byte> buffer) override {
             return this->hStream->WriteSome(buffer);
         }
+
+        size_t
+        WriteSomeV(std::span<const std::span<const std::byte>> buffers) override {
+            return this->hStream->WriteSomeV(buffers);
+        }
+
+        std::span<std::byte>
+        BorrowWrite(size_t uMinSize) override {
+            return this->hStream->BorrowWrite(uMinSize);
+        }
+
+        void
+        Commit(size_t uCount) override {
+            this->hStream->Commit(uCount);
+        }
     };
 
-    class INetworkStream :
+    class INetworkStream final :
         public SerialIStream,
         public __impl::NetworkStreamBase {
     public:
-        INetworkStream(int fdSocket) :
-            NetworkStreamBase(fdSocket) {
+        INetworkStream(int fdSocket, const NetworkBuffers& buffers = {}) :
+            NetworkStreamBase(fdSocket, buffers) {
                 shutdown(this->hStream->Descriptor(), SHUT_WR);
             }
 
@@ -477,18 +1194,33 @@ namespace io {
             return this->hStream->ReadSome(buffer);
         }
 
+        size_t
+        ReadSomeV(std::span<const std::span<std::byte>> buffers) override {
+            return this->hStream->ReadSomeV(buffers);
+        }
+
         bool
         PutBack(std::byte c) override {
             return this->hStream->PutBack(c);
         }
+
+        std::span<const std::byte>
+        BorrowRead() override {
+            return this->hStream->BorrowRead();
+        }
+
+        void
+        Consume(size_t uCount) override {
+            this->hStream->Consume(uCount);
+        }
     };
 
-    class ONetworkStream :
+    class ONetworkStream final :
         public SerialOStream,
         public __impl::NetworkStreamBase {
     public:
-        ONetworkStream(int fdSocket) :
-            NetworkStreamBase(fdSocket) {
+        ONetworkStream(int fdSocket, const NetworkBuffers& buffers = {}) :
+            NetworkStreamBase(fdSocket, buffers) {
                 shutdown(this->hStream->Descriptor(), SHUT_RD);
             }
 
@@ -501,14 +1233,29 @@ namespace io {
         WriteSome(std::span<const std::byte> buffer) override {
             return this->hStream->WriteSome(buffer);
         }
+
+        size_t
+        WriteSomeV(std::span<const std::span<const std::byte>> buffers) override {
+            return this->hStream->WriteSomeV(buffers);
+        }
+
+        std::span<std::byte>
+        BorrowWrite(size_t uMinSize) override {
+            return this->hStream->BorrowWrite(uMinSize);
+        }
+
+        void
+        Commit(size_t uCount) override {
+            this->hStream->Commit(uCount);
+        }
     };
 
-    class IONetworkStream :
+    class IONetworkStream final :
         public SerialIOStream,
         public __impl::NetworkStreamBase {
     public:
-        IONetworkStream(int fdSocket) :
-            NetworkStreamBase(fdSocket) {}
+        IONetworkStream(int fdSocket, const NetworkBuffers& buffers = {}) :
+            NetworkStreamBase(fdSocket, buffers) {}
         
         std::optional<std::byte>
         Read() override {
@@ -520,11 +1267,26 @@ namespace io {
             return this->hStream->ReadSome(buffer);
         }
 
+        size_t
+        ReadSomeV(std::span<const std::span<std::byte>> buffers) override {
+            return this->hStream->ReadSomeV(buffers);
+        }
+
         bool
         PutBack(std::byte c) override {
             return this->hStream->PutBack(c);
         }
 
+        std::span<const std::byte>
+        BorrowRead() override {
+            return this->hStream->BorrowRead();
+        }
+
+        void
+        Consume(size_t uCount) override {
+            this->hStream->Consume(uCount);
+        }
+
         bool
         Write(std::byte c) override {
             return this->hStream->Write(c);
@@ -534,6 +1296,21 @@ namespace io {
         WriteSome(std::span<const std::byte> buffer) override {
             return this->hStream->WriteSome(buffer);
         }
+
+        size_t
+        WriteSomeV(std::span<const std::span<const std::byte>> buffers) override {
+            return this->hStream->WriteSomeV(buffers);
+        }
+
+        std::span<std::byte>
+        BorrowWrite(size_t uMinSize) override {
+            return this->hStream->BorrowWrite(uMinSize);
+        }
+
+        void
+        Commit(size_t uCount) override {
+            this->hStream->Commit(uCount);
+        }
     };
 
     namespace IPv4 {
@@ -0,0 +1,342 @@
+#pragma once
+#include <atomic>
+#include <memory>
+#include <vector>
+#include <cerrno>
+#include <cstdint>
+#include <stdexcept>
+#include <functional>
+#include <unordered_map>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+
+#include "NetworkStreams.hpp"
+
+
+namespace io {
+    namespace __impl {
+        inline bool
+        SetNonBlocking(int fd) noexcept {
+            int
+                iFlags  = fcntl(fd, F_GETFL);
+            return iFlags >= 0 && fcntl(fd, F_SETFL, iFlags | O_NONBLOCK) == 0;
+        }
+
+        // accept() failures worth retrying straight away: interruptions, and
+        // the network errors Linux reports for a connection that died queued
+        inline bool
+        AcceptRetryable(int iError) noexcept {
+            switch (iError) {
+            case EINTR:
+            case ECONNABORTED:
+            case EPROTO:
+            case ENOPROTOOPT:
+            case ENONET:
+            case ENETDOWN:
+            case ENETUNREACH:
+            case EHOSTDOWN:
+            case EHOSTUNREACH:
+            case EOPNOTSUPP:
+                return true;
+
+            default:
+                return false;
+            }
+        }
+
+        // out of descriptors or memory: the connection waits in the backlog
+        // until something is released
+        inline bool
+        AcceptExhausted(int iError) noexcept {
+            return iError == EMFILE || iError == ENFILE || iError == ENOBUFS || iError == ENOMEM;
+        }
+    }
+
+    // serves every connection of one listening socket from a single thread.
+    // sockets run non-blocking under edge-triggered epoll: OnData handlers
+    // find the input already received in the stream's buffer and should
+    // consume what they can, since leftovers are offered again only once
+    // more bytes arrive or the socket takes output again. the buffer grows
+    // while leftovers fill it. output is flushed whenever the socket has
+    // room, and once all of it is out OnWritable handlers carry on with
+    // replies the output buffer couldn't take in one go, doing nothing
+    // when there's nothing left to send
+    template<typename AddressT>
+    class NetworkReactor {
+    public:
+        struct Connection {
+            IONetworkStream
+                stream;
+            AddressT
+                addr;
+            bool
+                bClosing    = false;
+        };
+
+        using Handler   =
+            std::function<void(Connection&)>;
+
+        NetworkReactor(
+            const AddressT&         addr,
+            int                     iPendingConnections = 1024,
+            const NetworkBuffers&   buffers             = {}) :
+            server(addr, iPendingConnections, buffers),
+            fdEpoll(epoll_create1(EPOLL_CLOEXEC)),
+            fdWake(eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC))
+        {
+            if (this->fdEpoll < 0 || this->fdWake < 0 ||
+                !__impl::SetNonBlocking(this->server.Descriptor()) ||
+                !this->Register(this->server.Descriptor(), &this->server, EPOLLIN | EPOLLET) ||
+                !this->Register(this->fdWake, &this->fdWake, EPOLLIN))
+            {
+                this->CloseDescriptors();
+                throw std::runtime_error("failed to set up the event loop");
+            }
+        }
+
+        NetworkReactor(const NetworkReactor&) = delete;
+        NetworkReactor&
+        operator=(const NetworkReactor&) = delete;
+
+        ~NetworkReactor() noexcept {
+            this->mapConnections.clear();
+            this->CloseDescriptors();
+        }
+
+        void
+        OnAccept(Handler fnHandler) {
+            this->fnAccept  = std::move(fnHandler);
+        }
+
+        void
+        OnData(Handler fnHandler) {
+            this->fnData    = std::move(fnHandler);
+        }
+
+        void
+        OnWritable(Handler fnHandler) {
+            this->fnWritable    = std::move(fnHandler);
+        }
+
+        void
+        OnClose(Handler fnHandler) {
+            this->fnClose   = std::move(fnHandler);
+        }
+
+        // closes the connection once the current round of events is done
+        void
+        Close(Connection& connection) noexcept {
+            if (!connection.bClosing) {
+                connection.bClosing = true;
+                this->vecClosing.push_back(connection.stream.Handle()->Descriptor());
+            }
+        }
+
+        [[nodiscard]] size_t
+        Connections() const noexcept {
+            return this->mapConnections.size();
+        }
+
+        // waits up to iTimeoutMs (-1 for ever) and dispatches what's ready
+        bool
+        RunOnce(int iTimeoutMs = -1) {
+            struct epoll_event
+                lpEvents[uMaxEvents];
+            int
+                iCount  = epoll_wait(this->fdEpoll, lpEvents, (int)uMaxEvents, iTimeoutMs);
+            if (iCount < 0)
+                return errno == EINTR;
+
+            for (int i = 0; i != iCount; ++i) {
+                void*
+                    lpTarget    = lpEvents[i].data.ptr;
+                if (lpTarget == &this->server) {
+                    this->AcceptAll();
+                } else if (lpTarget == &this->fdWake) {
+                    uint64_t
+                        uCount  = 0;
+                    (void)read(this->fdWake, &uCount, sizeof(uCount));
+                } else {
+                    this->Dispatch(*(Connection*)lpTarget, lpEvents[i].events);
+                }
+            }
+
+            this->Reap();
+            return true;
+        }
+
+        void
+        Run() {
+            this->bStop.store(false, std::memory_order_relaxed);
+            while (!this->bStop.load(std::memory_order_relaxed)) {
+                if (!this->RunOnce())
+                    break;
+            }
+        }
+
+        // safe to call from any thread, including handlers
+        void
+        Stop() noexcept {
+            this->bStop.store(true, std::memory_order_relaxed);
+            uint64_t
+                uCount  = 1;
+            (void)write(this->fdWake, &uCount, sizeof(uCount));
+        }
+
+    private:
+        static constexpr size_t
+            uMaxEvents  = 256;
+
+        bool
+        Register(int fd, void* lpTarget, uint32_t uEvents) noexcept {
+            struct epoll_event
+                event   = {};
+            event.events    = uEvents;
+            event.data.ptr  = lpTarget;
+            return epoll_ctl(this->fdEpoll, EPOLL_CTL_ADD, fd, &event) == 0;
+        }
+
+        // the listening socket is edge-triggered, so this has to drain the
+        // backlog. when out of descriptors it stops and Reap() retries once
+        // a connection has been closed, since no new edge may ever come
+        void
+        AcceptAll() {
+            this->bAcceptBlocked    = false;
+            for (;;) {
+                auto
+                    optConnection   = this->server.Accept();
+                if (!optConnection) {
+                    if (__impl::AcceptRetryable(errno))
+                        continue;
+
+                    this->bAcceptBlocked    = __impl::AcceptExhausted(errno);
+                    return;
+                }
+
+                int
+                    fd  = optConnection->first.Handle()->Descriptor();
+                std::unique_ptr<Connection>
+                    lpConnection(new Connection{
+                        std::move(optConnection->first),
+                        optConnection->second });
+                if (!__impl::SetNonBlocking(fd) ||
+                    !this->Register(fd, lpConnection.get(), EPOLLIN | EPOLLOUT | EPOLLRDHUP | EPOLLET))
+                    continue;
+
+                Connection&
+                    connection  = *lpConnection;
+                this->mapConnections.insert_or_assign(fd, std::move(lpConnection));
+                if (this->fnAccept)
+                    this->fnAccept(connection);
+                this->Settle(connection);
+            }
+        }
+
+        void
+        Dispatch(Connection& connection, uint32_t uEvents) {
+            if (connection.bClosing)
+                return;
+
+            __impl::BufferedNetworkStream&
+                stream  = *connection.stream.Handle();
+            if ((uEvents & EPOLLOUT) && stream.Flush() && this->fnWritable)
+                this->fnWritable(connection);
+
+            // input a handler left behind is offered again once it can reply
+            if (!connection.bClosing &&
+                ((uEvents & (EPOLLIN | EPOLLRDHUP | EPOLLHUP | EPOLLERR)) || stream.BufferedInput() != 0))
+            {
+                // edge-triggered: keep going until the socket runs dry
+                for (;;) {
+                    bool
+                        bReceived   = stream.Receive();
+                    size_t
+                        uBuffered   = stream.BufferedInput();
+                    if (uBuffered != 0 && this->fnData)
+                        this->fnData(connection);
+
+                    if (connection.bClosing || stream.Error())
+                        break;
+                    if (!bReceived && (stream.WouldBlock() || stream.BufferedInput() == uBuffered))
+                        break;
+                }
+            }
+
+            this->Settle(connection);
+        }
+
+        // flushes what the handlers wrote and closes finished connections,
+        // letting a closed input side wait for its replies to drain. one
+        // left with nothing buffered gives its buffers back until next time
+        void
+        Settle(Connection& connection) {
+            if (connection.bClosing)
+                return;
+
+            __impl::BufferedNetworkStream&
+                stream  = *connection.stream.Handle();
+            stream.Flush();
+            if (stream.Error() && (stream.PendingOutput() == 0 || !stream.WouldBlock()))
+                this->Close(connection);
+            else if (stream.BufferedInput() == 0 && stream.PendingOutput() == 0)
+                stream.Trim();
+        }
+
+        // each pass frees descriptors, so a blocked accept gets another go;
+        // what it accepts and closes at once is reaped by the next pass
+        void
+        Reap() {
+            while (!this->vecClosing.empty()) {
+                for (size_t i = 0; i != this->vecClosing.size(); ++i) {
+                    int
+                        fd  = this->vecClosing[i];
+                    auto
+                        it  = this->mapConnections.find(fd);
+                    if (it == this->mapConnections.end())
+                        continue;
+
+                    epoll_ctl(this->fdEpoll, EPOLL_CTL_DEL, fd, nullptr);
+                    if (this->fnClose)
+                        this->fnClose(*it->second);
+                    this->mapConnections.erase(it);
+                }
+
+                this->vecClosing.clear();
+                if (this->bAcceptBlocked)
+                    this->AcceptAll();
+            }
+        }
+
+        void
+        CloseDescriptors() noexcept {
+            if (this->fdEpoll >= 0)
+                close(this->fdEpoll);
+            if (this->fdWake >= 0)
+                close(this->fdWake);
+            this->fdEpoll   = -1;
+            this->fdWake    = -1;
+        }
+
+        __impl::BasicServer<AddressT, IONetworkStream>
+            server;
+        int
+            fdEpoll     = -1,
+            fdWake      = -1;
+        std::atomic<bool>
+            bStop       = false;
+        bool
+            bAcceptBlocked  = false;
+        Handler
+            fnAccept,
+            fnData,
+            fnWritable,
+            fnClose;
+        std::unordered_map<int, std::unique_ptr<Connection>>
+            mapConnections;
+        std::vector<int>
+            vecClosing;
+    };
+}
@@ -0,0 +1,377 @@
+#pragma once
+#include <atomic>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <format>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include <algorithm>
+#include <stdexcept>
+#include <string_view>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#include "IOStreams.hpp"
+#include "FdStreams.hpp"
+
+
+namespace io {
+    namespace __impl {
+        class RegionStreamBase :
+            virtual public  StreamState,
+            virtual public  StreamPosition {
+        public:
+            static constexpr size_t
+                uDefaultBufferSize  = 256 * 1024;
+
+            RegionStreamBase(int fd, uint64_t uBase, uint64_t uSize, size_t uBufferSize) :
+                fd(fd),
+                uBase(uBase),
+                uSize(uSize),
+                lpBuffer(new std::byte[std::max<size_t>(uBufferSize, 1)]),
+                uBufferSize(std::max<size_t>(uBufferSize, 1)) {}
+
+            RegionStreamBase(const RegionStreamBase&) = delete;
+            RegionStreamBase&
+            operator=(const RegionStreamBase&) = delete;
+
+            ~RegionStreamBase() noexcept {
+                this->FlushBuffer();
+            }
+
+            [[nodiscard]] bool
+            EndOfStream() const noexcept override {
+                return this->uPos + this->uFill == this->uSize;
+            }
+
+            [[nodiscard]] bool
+            Good() const noexcept override {
+                return !this->bErr;
+            }
+
+            void
+            ClearFlags() noexcept override {
+                this->bErr  = false;
+            }
+
+            bool
+            Flush() noexcept override {
+                return this->FlushBuffer();
+            }
+
+            [[nodiscard]] intptr_t
+            GetPosition() const noexcept override {
+                return (intptr_t)(this->uPos + this->uFill);
+            }
+
+            bool
+            SetPosition(
+                intptr_t            offset,
+                StreamOffsetOrigin  from = StreamOffsetOrigin::StreamStart) override
+            {
+                if (!this->FlushBuffer())
+                    return false;
+
+                switch (from) {
+                case StreamOffsetOrigin::CurrentPos:
+                    offset  += (intptr_t)this->uPos;
+                    break;
+
+                case StreamOffsetOrigin::StreamStart:
+                    offset  += 0;
+                    break;
+
+                case StreamOffsetOrigin::StreamEnd:
+                    offset  += (intptr_t)this->uSize;
+                    break;
+                }
+
+                if (offset < 0 || (uint64_t)offset > this->uSize)
+                    return false;
+
+                this->uPos  = (uint64_t)offset;
+                return true;
+            }
+
+            [[nodiscard]] uint64_t
+            Base() const noexcept {
+                return this->uBase;
+            }
+
+            [[nodiscard]] uint64_t
+            Size() const noexcept {
+                return this->uSize;
+            }
+
+        protected:
+            bool
+            Write(std::byte c) {
+                if (this->uPos + this->uFill == this->uSize) {
+                    this->bErr  = true;
+                    return false;
+                }
+                if (this->uFill == this->uBufferSize && !this->FlushBuffer())
+                    return false;
+
+                this->lpBuffer[this->uFill++] = c;
+                return true;
+            }
+
+            size_t
+            WriteSome(std::span<const std::byte> buffer) {
+                uint64_t
+                    uRoom       = this->uSize - this->uPos - this->uFill;
+                bool
+                    bOverflow   = buffer.size() > uRoom;
+                if (bOverflow)
+                    buffer  = buffer.first((size_t)uRoom);
+
+                // what still fits is written before the overflow is recorded
+                size_t
+                    uWritten    = this->WriteInRange(buffer);
+                if (bOverflow)
+                    this->bErr  = true;
+                return uWritten;
+            }
+
+            std::span<std::byte>
+            BorrowWrite(size_t uMinSize) {
+                if (this->uBufferSize - this->uFill < uMinSize && !this->FlushBuffer())
+                    return {};
+
+                size_t
+                    uWindow = (size_t)std::min<uint64_t>(
+                        this->uBufferSize - this->uFill,
+                        this->uSize - this->uPos - this->uFill);
+                if (uWindow < std::max<size_t>(uMinSize, 1))
+                    return {};
+
+                return { this->lpBuffer.get() + this->uFill, uWindow };
+            }
+
+            void
+            Commit(size_t uCount) {
+                this->uFill += uCount;
+            }
+
+            size_t
+            WriteAt(uint64_t uOffset, std::span<const std::byte> buffer) {
+                if (uOffset >= this->uSize)
+                    return 0;
+
+                buffer  = buffer.first((size_t)std::min<uint64_t>(buffer.size(), this->uSize - uOffset));
+                if (!this->FlushBuffer())
+                    return 0;
+
+                size_t
+                    uWritten    = PositionalWrite(this->fd, this->uBase + uOffset, buffer);
+                if (uWritten != buffer.size())
+                    this->bErr  = true;
+                return uWritten;
+            }
+
+        private:
+            size_t
+            WriteInRange(std::span<const std::byte> buffer) {
+                if (buffer.size() > this->uBufferSize - this->uFill) {
+                    if (!this->FlushBuffer())
+                        return 0;
+
+                    if (buffer.size() >= this->uBufferSize) {
+                        size_t
+                            uWritten    = PositionalWrite(this->fd, this->uBase + this->uPos, buffer);
+                        this->uPos  += uWritten;
+                        if (uWritten != buffer.size())
+                            this->bErr  = true;
+                        return uWritten;
+                    }
+                }
+
+                memcpy(this->lpBuffer.get() + this->uFill, buffer.data(), buffer.size());
+                this->uFill += buffer.size();
+                return buffer.size();
+            }
+
+            bool
+            FlushBuffer() noexcept {
+                if (this->uFill == 0)
+                    return !this->bErr;
+
+                size_t
+                    uWritten    = PositionalWrite(
+                        this->fd, this->uBase + this->uPos,
+                        { this->lpBuffer.get(), this->uFill });
+                this->uPos  += uWritten;
+                if (uWritten != this->uFill) {
+                    memmove(this->lpBuffer.get(), this->lpBuffer.get() + uWritten, this->uFill - uWritten);
+                    this->uFill -= uWritten;
+                    this->bErr  = true;
+                    return false;
+                }
+
+                this->uFill = 0;
+                return !this->bErr;
+            }
+
+            int
+                fd          = -1;
+            uint64_t
+                uBase       = 0,
+                uSize       = 0,
+                uPos        = 0;
+            std::unique_ptr<std::byte[]>
+                lpBuffer;
+            size_t
+                uBufferSize = 0,
+                uFill       = 0;
+            bool
+                bErr        = false;
+        };
+    }
+
+    class RegionOStream final :
+        public  OStream,
+        public  __impl::RegionStreamBase {
+    public:
+        RegionOStream(int fd, uint64_t uBase, uint64_t uSize, size_t uBufferSize = uDefaultBufferSize) :
+            RegionStreamBase(fd, uBase, uSize, uBufferSize) {}
+
+        bool
+        Write(std::byte c) override {
+            return this->RegionStreamBase::Write(c);
+        }
+
+        size_t
+        WriteSome(std::span<const std::byte> buffer) override {
+            return this->RegionStreamBase::WriteSome(buffer);
+        }
+
+        std::span<std::byte>
+        BorrowWrite(size_t uMinSize) override {
+            return this->RegionStreamBase::BorrowWrite(uMinSize);
+        }
+
+        void
+        Commit(size_t uCount) override {
+            this->RegionStreamBase::Commit(uCount);
+        }
+
+        size_t
+        WriteAt(uint64_t uOffset, std::span<const std::byte> buffer) override {
+            return this->RegionStreamBase::WriteAt(uOffset, buffer);
+        }
+    };
+
+    // the file is only cut to the end of the last region when the writer
+    // owns its length: it truncated the file or found it empty. patching
+    // regions of an existing file leaves the rest of it alone
+    class ParallelFileWriter {
+    public:
+        ParallelFileWriter(std::string_view strvFilename, int iFlags = O_WRONLY | O_CREAT | O_TRUNC) :
+            fd(open(std::string(strvFilename).c_str(), iFlags | O_CLOEXEC, 0666))
+        {
+            if (this->fd < 0) {
+                throw std::runtime_error(std::format(
+                    "failed to open file {}: {}",
+                    strvFilename, strerror(errno)));
+            }
+
+            struct stat
+                st;
+            this->bTruncate = (iFlags & O_TRUNC) != 0 ||
+                (fstat(this->fd, &st) == 0 && st.st_size == 0);
+        }
+
+        ParallelFileWriter(const ParallelFileWriter&) = delete;
+        ParallelFileWriter&
+        operator=(const ParallelFileWriter&) = delete;
+
+        ~ParallelFileWriter() noexcept {
+            this->Finish();
+            close(this->fd);
+        }
+
+        [[nodiscard]] int
+        Descriptor() const noexcept {
+            return this->fd;
+        }
+
+        // reserves [uOffset, uOffset + uSize) of the file; regions handed
+        // to different threads must not overlap
+        RegionOStream
+        Region(uint64_t uOffset, uint64_t uSize, size_t uBufferSize = RegionOStream::uDefaultBufferSize) {
+            uint64_t
+                uEnd        = uOffset + uSize,
+                uCurrent    = this->uEnd.load(std::memory_order_relaxed);
+            while (uCurrent < uEnd && !this->uEnd.compare_exchange_weak(uCurrent, uEnd, std::memory_order_relaxed)) {}
+
+            return RegionOStream(this->fd, uOffset, uSize, uBufferSize);
+        }
+
+        // writes consecutive regions of the given sizes, one thread each,
+        // then waits for all of them and finishes the file
+        template<typename FnT> requires
+            std::invocable<FnT&, size_t, RegionOStream&>
+        bool
+        Run(
+            std::span<const uint64_t>   sizes,
+            FnT&&                       fnWorker,
+            size_t                      uBufferSize = RegionOStream::uDefaultBufferSize)
+        {
+            std::vector<uint64_t>
+                vecOffsets(sizes.size());
+            uint64_t
+                uTotal  = 0;
+            for (size_t i = 0; i < sizes.size(); ++i) {
+                vecOffsets[i]   = uTotal;
+                uTotal          += sizes[i];
+            }
+
+#if defined(__linux__)
+            if (uTotal != 0)
+                (void)posix_fallocate(this->fd, 0, (off_t)uTotal);
+#endif
+
+            std::atomic<bool>
+                bFailed = false;
+            std::vector<std::thread>
+                vecThreads;
+            vecThreads.reserve(sizes.size());
+            for (size_t i = 0; i < sizes.size(); ++i) {
+                vecThreads.emplace_back([&, i] {
+                    RegionOStream
+                        region  = this->Region(vecOffsets[i], sizes[i], uBufferSize);
+                    fnWorker(i, region);
+                    if (!region.Flush())
+                        bFailed.store(true, std::memory_order_relaxed);
+                });
+            }
+            for (auto& thread : vecThreads)
+                thread.join();
+
+            return this->Finish() && !bFailed.load(std::memory_order_relaxed);
+        }
+
+        // drops whatever preallocation ran past the last region
+        bool
+        Finish() noexcept {
+            if (!this->bTruncate || this->uEnd.load(std::memory_order_relaxed) == 0)
+                return true;
+
+            return ftruncate(this->fd, (off_t)this->uEnd.load(std::memory_order_relaxed)) == 0;
+        }
+
+    private:
+        int
+            fd          = -1;
+        bool
+            bTruncate   = false;
+        std::atomic<uint64_t>
+            uEnd        = 0;
+    };
+}
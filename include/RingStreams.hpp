@@ -0,0 +1,421 @@
+#pragma once
+#include <bit>
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+
+#include "IOStreams.hpp"
+
+
+namespace io {
+    enum class RingWaitPolicy {
+        Block   = 0,    // sleep on a futex until the other end makes progress
+        Spin    = 1     // busy-wait, for threads pinned to their own cores
+    };
+
+    class IRingBufferStream;
+    class ORingBufferStream;
+
+    class RingBuffer {
+    public:
+        RingBuffer(size_t uCapacity) :
+            lpData(new std::byte[std::bit_ceil(std::max<size_t>(uCapacity, 2))]),
+            uMask(std::bit_ceil(std::max<size_t>(uCapacity, 2)) - 1) {}
+
+        RingBuffer(const RingBuffer&) = delete;
+        RingBuffer&
+        operator=(const RingBuffer&) = delete;
+
+        [[nodiscard]] size_t
+        Capacity() const noexcept {
+            return this->uMask + 1;
+        }
+
+    private:
+        friend class IRingBufferStream;
+        friend class ORingBufferStream;
+
+        static constexpr size_t
+            uCacheLine  = 64;
+
+        static void
+        Relax(size_t& uSpins) noexcept {
+#if defined(__x86_64__) || defined(__i386__)
+            if (uSpins++ < 1024) {
+                __builtin_ia32_pause();
+                return;
+            }
+#endif
+            std::this_thread::yield();
+        }
+
+        size_t
+        Pop(std::span<std::byte> buffer) noexcept {
+            size_t
+                uHead       = this->r.uHead.load(std::memory_order_relaxed),
+                uAvailable  = this->r.uCachedTail - uHead;
+            if (uAvailable < buffer.size()) {
+                this->r.uCachedTail = this->w.uTail.load(std::memory_order_acquire);
+                uAvailable          = this->r.uCachedTail - uHead;
+            }
+
+            size_t
+                uCount  = std::min(uAvailable, buffer.size());
+            if (uCount == 0)
+                return 0;
+
+            size_t
+                uOffset = uHead & this->uMask,
+                uFirst  = std::min(uCount, this->uMask + 1 - uOffset);
+            memcpy(buffer.data(), this->lpData.get() + uOffset, uFirst);
+            memcpy(buffer.data() + uFirst, this->lpData.get(), uCount - uFirst);
+            this->r.uHead.store(uHead + uCount, std::memory_order_seq_cst);
+
+            if (this->w.bWaiting.load(std::memory_order_seq_cst)) {
+                this->r.uEpoch.fetch_add(1, std::memory_order_release);
+                this->r.uEpoch.notify_one();
+            }
+
+            return uCount;
+        }
+
+        size_t
+        Push(std::span<const std::byte> buffer) noexcept {
+            size_t
+                uTail   = this->w.uTail.load(std::memory_order_relaxed),
+                uFree   = this->Capacity() - (uTail - this->w.uCachedHead);
+            if (uFree < buffer.size()) {
+                this->w.uCachedHead = this->r.uHead.load(std::memory_order_acquire);
+                uFree               = this->Capacity() - (uTail - this->w.uCachedHead);
+            }
+
+            size_t
+                uCount  = std::min(uFree, buffer.size());
+            if (uCount == 0)
+                return 0;
+
+            size_t
+                uOffset = uTail & this->uMask,
+                uFirst  = std::min(uCount, this->uMask + 1 - uOffset);
+            memcpy(this->lpData.get() + uOffset, buffer.data(), uFirst);
+            memcpy(this->lpData.get(), buffer.data() + uFirst, uCount - uFirst);
+            this->w.uTail.store(uTail + uCount, std::memory_order_seq_cst);
+
+            if (this->r.bWaiting.load(std::memory_order_seq_cst)) {
+                this->w.uEpoch.fetch_add(1, std::memory_order_release);
+                this->w.uEpoch.notify_one();
+            }
+
+            return uCount;
+        }
+
+        bool
+        WaitReadable(RingWaitPolicy policy) noexcept {
+            size_t
+                uHead   = this->r.uHead.load(std::memory_order_relaxed),
+                uSpins  = 0;
+            while (this->w.uTail.load(std::memory_order_acquire) == uHead) {
+                if (this->w.bClosed.load(std::memory_order_acquire))
+                    return this->w.uTail.load(std::memory_order_acquire) != uHead;
+
+                if (policy == RingWaitPolicy::Spin) {
+                    Relax(uSpins);
+                    continue;
+                }
+
+                uint32_t
+                    uEpoch  = this->w.uEpoch.load(std::memory_order_acquire);
+                this->r.bWaiting.store(true, std::memory_order_seq_cst);
+                if (this->w.uTail.load(std::memory_order_seq_cst) == uHead &&
+                    !this->w.bClosed.load(std::memory_order_seq_cst))
+                {
+                    this->w.uEpoch.wait(uEpoch, std::memory_order_acquire);
+                }
+                this->r.bWaiting.store(false, std::memory_order_relaxed);
+            }
+
+            return true;
+        }
+
+        bool
+        WaitWritable(RingWaitPolicy policy) noexcept {
+            size_t
+                uTail   = this->w.uTail.load(std::memory_order_relaxed),
+                uSpins  = 0;
+            while (uTail - this->r.uHead.load(std::memory_order_acquire) == this->Capacity()) {
+                if (this->r.bClosed.load(std::memory_order_acquire))
+                    return false;
+
+                if (policy == RingWaitPolicy::Spin) {
+                    Relax(uSpins);
+                    continue;
+                }
+
+                uint32_t
+                    uEpoch  = this->r.uEpoch.load(std::memory_order_acquire);
+                this->w.bWaiting.store(true, std::memory_order_seq_cst);
+                if (uTail - this->r.uHead.load(std::memory_order_seq_cst) == this->Capacity() &&
+                    !this->r.bClosed.load(std::memory_order_seq_cst))
+                {
+                    this->r.uEpoch.wait(uEpoch, std::memory_order_acquire);
+                }
+                this->w.bWaiting.store(false, std::memory_order_relaxed);
+            }
+
+            return !this->r.bClosed.load(std::memory_order_acquire);
+        }
+
+        void
+        CloseReader() noexcept {
+            this->r.bClosed.store(true, std::memory_order_seq_cst);
+            this->r.uEpoch.fetch_add(1, std::memory_order_release);
+            this->r.uEpoch.notify_one();
+        }
+
+        void
+        CloseWriter() noexcept {
+            this->w.bClosed.store(true, std::memory_order_seq_cst);
+            this->w.uEpoch.fetch_add(1, std::memory_order_release);
+            this->w.uEpoch.notify_one();
+        }
+
+        struct alignas(uCacheLine) ReaderSide {
+            std::atomic<size_t>
+                uHead       = 0;
+            std::atomic<uint32_t>
+                uEpoch      = 0;
+            std::atomic<bool>
+                bWaiting    = false,
+                bClosed     = false;
+            size_t
+                uCachedTail = 0;
+        } r;
+
+        struct alignas(uCacheLine) WriterSide {
+            std::atomic<size_t>
+                uTail       = 0;
+            std::atomic<uint32_t>
+                uEpoch      = 0;
+            std::atomic<bool>
+                bWaiting    = false,
+                bClosed     = false;
+            size_t
+                uCachedHead = 0;
+        } w;
+
+        alignas(uCacheLine) std::unique_ptr<std::byte[]>
+            lpData;
+        size_t
+            uMask   = 0;
+    };
+
+    class IRingBufferStream final :
+        public SerialIStream {
+    public:
+        IRingBufferStream(RingBuffer& ring, RingWaitPolicy policy = RingWaitPolicy::Block) :
+            refRing(ring),
+            policy(policy) {}
+
+        IRingBufferStream(const IRingBufferStream&) = delete;
+        IRingBufferStream&
+        operator=(const IRingBufferStream&) = delete;
+
+        ~IRingBufferStream() noexcept {
+            this->refRing.CloseReader();
+        }
+
+        [[nodiscard]] bool
+        EndOfStream() const noexcept override {
+            return this->bEOF;
+        }
+
+        [[nodiscard]] bool
+        Good() const noexcept override {
+            return true;
+        }
+
+        void
+        ClearFlags() noexcept override {
+            this->bEOF  = false;
+        }
+
+        bool
+        Flush() noexcept override {
+            return true;
+        }
+
+        std::optional<std::byte>
+        Read() override {
+            std::byte
+                c;
+            if (this->ReadSome({ &c, 1 }) != 1)
+                return std::nullopt;
+            return c;
+        }
+
+        size_t
+        ReadSome(std::span<std::byte> buffer) override {
+            return this->ReadSomeImpl(buffer, this->policy);
+        }
+
+        size_t
+        TryReadSome(std::span<std::byte> buffer) noexcept {
+            size_t
+                uRead   = this->ReadRetBuf(buffer);
+            return uRead + this->refRing.Pop(buffer.subspan(uRead));
+        }
+
+        size_t
+        SpinReadSome(std::span<std::byte> buffer) noexcept {
+            return this->ReadSomeImpl(buffer, RingWaitPolicy::Spin);
+        }
+
+        size_t
+        WaitReadSome(std::span<std::byte> buffer) noexcept {
+            return this->ReadSomeImpl(buffer, RingWaitPolicy::Block);
+        }
+
+        bool
+        PutBack(std::byte c) override {
+            if (this->uRetLen == sizeof(this->lpRetBuf))
+                return false;
+
+            this->lpRetBuf[this->uRetLen++] = c;
+            this->bEOF  = false;
+            return true;
+        }
+
+    private:
+        size_t
+        ReadRetBuf(std::span<std::byte> buffer) noexcept {
+            size_t
+                uRead   = 0;
+            while (this->uRetLen != 0 && uRead != buffer.size())
+                buffer[uRead++] = this->lpRetBuf[--this->uRetLen];
+            return uRead;
+        }
+
+        size_t
+        ReadSomeImpl(std::span<std::byte> buffer, RingWaitPolicy waitPolicy) noexcept {
+            size_t
+                uRead   = this->ReadRetBuf(buffer);
+            while (uRead != buffer.size()) {
+                uRead   += this->refRing.Pop(buffer.subspan(uRead));
+                if (uRead != buffer.size() && !this->refRing.WaitReadable(waitPolicy)) {
+                    this->bEOF  = true;
+                    break;
+                }
+            }
+
+            return uRead;
+        }
+
+        RingBuffer&
+            refRing;
+        RingWaitPolicy
+            policy;
+        bool
+            bEOF    = false;
+        uint8_t
+            uRetLen = 0;
+        std::byte
+            lpRetBuf[6];
+    };
+
+    class ORingBufferStream final :
+        public SerialOStream {
+    public:
+        ORingBufferStream(RingBuffer& ring, RingWaitPolicy policy = RingWaitPolicy::Block) :
+            refRing(ring),
+            policy(policy) {}
+
+        ORingBufferStream(const ORingBufferStream&) = delete;
+        ORingBufferStream&
+        operator=(const ORingBufferStream&) = delete;
+
+        ~ORingBufferStream() noexcept {
+            this->Close();
+        }
+
+        [[nodiscard]] bool
+        EndOfStream() const noexcept override {
+            return false;
+        }
+
+        [[nodiscard]] bool
+        Good() const noexcept override {
+            return !this->bErr;
+        }
+
+        void
+        ClearFlags() noexcept override {
+            this->bErr  = false;
+        }
+
+        bool
+        Flush() noexcept override {
+            return !this->bErr;
+        }
+
+        void
+        Close() noexcept {
+            this->refRing.CloseWriter();
+        }
+
+        bool
+        Write(std::byte c) override {
+            return this->WriteSome({ &c, 1 }) == 1;
+        }
+
+        size_t
+        WriteSome(std::span<const std::byte> buffer) override {
+            return this->WriteSomeImpl(buffer, this->policy);
+        }
+
+        size_t
+        TryWriteSome(std::span<const std::byte> buffer) noexcept {
+            return this->refRing.Push(buffer);
+        }
+
+        size_t
+        SpinWriteSome(std::span<const std::byte> buffer) noexcept {
+            return this->WriteSomeImpl(buffer, RingWaitPolicy::Spin);
+        }
+
+        size_t
+        WaitWriteSome(std::span<const std::byte> buffer) noexcept {
+            return this->WriteSomeImpl(buffer, RingWaitPolicy::Block);
+        }
+
+    private:
+        size_t
+        WriteSomeImpl(std::span<const std::byte> buffer, RingWaitPolicy waitPolicy) noexcept {
+            if (this->refRing.r.bClosed.load(std::memory_order_acquire)) {
+                this->bErr  = true;
+                return 0;
+            }
+
+            size_t
+                uWritten    = 0;
+            while (uWritten != buffer.size()) {
+                uWritten    += this->refRing.Push(buffer.subspan(uWritten));
+                if (uWritten != buffer.size() && !this->refRing.WaitWritable(waitPolicy)) {
+                    this->bErr  = true;
+                    break;
+                }
+            }
+
+            return uWritten;
+        }
+
+        RingBuffer&
+            refRing;
+        RingWaitPolicy
+            policy;
+        bool
+            bErr    = false;
+    };
+}
@@ -0,0 +1,341 @@
+#pragma once
+#include <cstdint>
+#include <cstring>
+#include <concepts>
+#include <algorithm>
+
+#include "IOStreams.hpp"
+
+
+namespace io {
+    namespace __impl {
+        template<typename ByteT> requires
+            std::same_as<std::remove_const_t<ByteT>, std::byte>
+        class SpanStreamBase :
+            virtual public  StreamState,
+            virtual public  StreamPosition {
+        public:
+            SpanStreamBase(std::span<ByteT> buffer) noexcept :
+                lpData(buffer.data()),
+                uSize(buffer.size()) {}
+
+            [[nodiscard]] bool
+            EndOfStream() const noexcept override {
+                return this->bEOF;
+            }
+
+            [[nodiscard]] bool
+            Good() const noexcept override {
+                return !this->bErr;
+            }
+
+            void
+            ClearFlags() noexcept override {
+                this->bEOF  = false;
+                this->bErr  = false;
+            }
+
+            bool
+            Flush() noexcept override {
+                return true;
+            }
+
+            [[nodiscard]] intptr_t
+            GetPosition() const noexcept override {
+                return (intptr_t)this->uPos;
+            }
+
+            bool
+            SetPosition(
+                intptr_t            offset,
+                StreamOffsetOrigin  from = StreamOffsetOrigin::StreamStart) override
+            {
+                switch (from) {
+                case StreamOffsetOrigin::CurrentPos:
+                    offset  += (intptr_t)this->uPos;
+                    break;
+
+                case StreamOffsetOrigin::StreamStart:
+                    offset  += 0;
+                    break;
+
+                case StreamOffsetOrigin::StreamEnd:
+                    offset  += (intptr_t)this->uSize;
+                    break;
+                }
+
+                if (offset < 0 || offset > (intptr_t)this->uSize)
+                    return false;
+
+                this->uPos  = (size_t)offset;
+                this->bEOF  = false;
+                return true;
+            }
+
+            [[nodiscard]] std::span<ByteT>
+            Buffer() const noexcept {
+                return { this->lpData, this->uSize };
+            }
+
+            [[nodiscard]] std::span<ByteT>
+            Remaining() const noexcept {
+                return { this->lpData + this->uPos, this->uSize - this->uPos };
+            }
+
+        protected:
+            std::optional<std::byte>
+            Read() noexcept {
+                if (this->uPos == this->uSize) {
+                    this->bEOF  = true;
+                    return std::nullopt;
+                }
+
+                return this->lpData[this->uPos++];
+            }
+
+            size_t
+            ReadSome(std::span<std::byte> buffer) noexcept {
+                size_t
+                    uCount  = std::min(buffer.size(), this->uSize - this->uPos);
+                if (uCount != 0)
+                    memcpy(buffer.data(), this->lpData + this->uPos, uCount);
+                if (uCount != buffer.size())
+                    this->bEOF  = true;
+
+                this->uPos  += uCount;
+                return uCount;
+            }
+
+            bool
+            PutBack(std::byte c) noexcept {
+                if (this->uPos == 0 || this->lpData[this->uPos - 1] != c)
+                    return false;
+
+                this->uPos  -= 1;
+                this->bEOF  = false;
+                return true;
+            }
+
+            std::span<const std::byte>
+            BorrowRead() const noexcept {
+                return this->Remaining();
+            }
+
+            void
+            Consume(size_t uCount) noexcept {
+                this->uPos  += uCount;
+            }
+
+            bool
+            Write(std::byte c) noexcept requires
+                (!std::is_const_v<ByteT>)
+            {
+                if (this->uPos == this->uSize) {
+                    this->bErr  = true;
+                    return false;
+                }
+
+                this->lpData[this->uPos++] = c;
+                return true;
+            }
+
+            size_t
+            WriteSome(std::span<const std::byte> buffer) noexcept requires
+                (!std::is_const_v<ByteT>)
+            {
+                size_t
+                    uCount  = std::min(buffer.size(), this->uSize - this->uPos);
+                if (uCount != 0)
+                    memcpy(this->lpData + this->uPos, buffer.data(), uCount);
+                if (uCount != buffer.size())
+                    this->bErr  = true;
+
+                this->uPos  += uCount;
+                return uCount;
+            }
+
+            std::span<std::byte>
+            BorrowWrite(size_t uMinSize) const noexcept requires
+                (!std::is_const_v<ByteT>)
+            {
+                if (this->uSize - this->uPos < uMinSize)
+                    return {};
+                return this->Remaining();
+            }
+
+            void
+            Commit(size_t uCount) noexcept requires
+                (!std::is_const_v<ByteT>)
+            {
+                this->uPos  += uCount;
+            }
+
+            size_t
+            ReadAt(uint64_t uOffset, std::span<std::byte> buffer) const noexcept {
+                if (uOffset >= this->uSize)
+                    return 0;
+
+                size_t
+                    uCount  = std::min(buffer.size(), this->uSize - (size_t)uOffset);
+                memcpy(buffer.data(), this->lpData + uOffset, uCount);
+                return uCount;
+            }
+
+            size_t
+            WriteAt(uint64_t uOffset, std::span<const std::byte> buffer) const noexcept requires
+                (!std::is_const_v<ByteT>)
+            {
+                if (uOffset >= this->uSize)
+                    return 0;
+
+                size_t
+                    uCount  = std::min(buffer.size(), this->uSize - (size_t)uOffset);
+                memcpy(this->lpData + uOffset, buffer.data(), uCount);
+                return uCount;
+            }
+
+            ByteT*
+                lpData  = nullptr;
+            size_t
+                uSize   = 0,
+                uPos    = 0;
+            bool
+                bEOF    = false,
+                bErr    = false;
+        };
+    }
+
+    class ISpanStream final :
+        public  IStream,
+        public  __impl::SpanStreamBase<const std::byte> {
+    public:
+        ISpanStream(std::span<const std::byte> buffer) noexcept :
+            SpanStreamBase(buffer) {}
+
+        std::optional<std::byte>
+        Read() override {
+            return this->SpanStreamBase::Read();
+        }
+
+        size_t
+        ReadSome(std::span<std::byte> buffer) override {
+            return this->SpanStreamBase::ReadSome(buffer);
+        }
+
+        bool
+        PutBack(std::byte c) override {
+            return this->SpanStreamBase::PutBack(c);
+        }
+
+        std::span<const std::byte>
+        BorrowRead() override {
+            return this->SpanStreamBase::BorrowRead();
+        }
+
+        void
+        Consume(size_t uCount) override {
+            this->SpanStreamBase::Consume(uCount);
+        }
+
+        size_t
+        ReadAt(uint64_t uOffset, std::span<std::byte> buffer) override {
+            return this->SpanStreamBase::ReadAt(uOffset, buffer);
+        }
+    };
+
+    class OSpanStream final :
+        public  OStream,
+        public  __impl::SpanStreamBase<std::byte> {
+    public:
+        OSpanStream(std::span<std::byte> buffer) noexcept :
+            SpanStreamBase(buffer) {}
+
+        bool
+        Write(std::byte c) override {
+            return this->SpanStreamBase::Write(c);
+        }
+
+        size_t
+        WriteSome(std::span<const std::byte> buffer) override {
+            return this->SpanStreamBase::WriteSome(buffer);
+        }
+
+        std::span<std::byte>
+        BorrowWrite(size_t uMinSize) override {
+            return this->SpanStreamBase::BorrowWrite(uMinSize);
+        }
+
+        void
+        Commit(size_t uCount) override {
+            this->SpanStreamBase::Commit(uCount);
+        }
+
+        size_t
+        WriteAt(uint64_t uOffset, std::span<const std::byte> buffer) override {
+            return this->SpanStreamBase::WriteAt(uOffset, buffer);
+        }
+    };
+
+    class IOSpanStream final :
+        public  IOStream,
+        public  __impl::SpanStreamBase<std::byte> {
+    public:
+        IOSpanStream(std::span<std::byte> buffer) noexcept :
+            SpanStreamBase(buffer) {}
+
+        std::optional<std::byte>
+        Read() override {
+            return this->SpanStreamBase::Read();
+        }
+
+        size_t
+        ReadSome(std::span<std::byte> buffer) override {
+            return this->SpanStreamBase::ReadSome(buffer);
+        }
+
+        bool
+        PutBack(std::byte c) override {
+            return this->SpanStreamBase::PutBack(c);
+        }
+
+        std::span<const std::byte>
+        BorrowRead() override {
+            return this->SpanStreamBase::BorrowRead();
+        }
+
+        void
+        Consume(size_t uCount) override {
+            this->SpanStreamBase::Consume(uCount);
+        }
+
+        bool
+        Write(std::byte c) override {
+            return this->SpanStreamBase::Write(c);
+        }
+
+        size_t
+        WriteSome(std::span<const std::byte> buffer) override {
+            return this->SpanStreamBase::WriteSome(buffer);
+        }
+
+        std::span<std::byte>
+        BorrowWrite(size_t uMinSize) override {
+            return this->SpanStreamBase::BorrowWrite(uMinSize);
+        }
+
+        void
+        Commit(size_t uCount) override {
+            this->SpanStreamBase::Commit(uCount);
+        }
+
+        size_t
+        ReadAt(uint64_t uOffset, std::span<std::byte> buffer) override {
+            return this->SpanStreamBase::ReadAt(uOffset, buffer);
+        }
+
+        size_t
+        WriteAt(uint64_t uOffset, std::span<const std::byte> buffer) override {
+            return this->SpanStreamBase::WriteAt(uOffset, buffer);
+        }
+    };
+}
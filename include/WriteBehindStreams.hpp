@@ -0,0 +1,318 @@
+#pragma once
+#include <deque>
+#include <mutex>
+#include <new>
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+#include <condition_variable>
+
+#include <unistd.h>
+
+#include "IOStreams.hpp"
+
+
+namespace io {
+    enum class WriteBehindPolicy {
+        Block   = 0,    // wait for the flusher to hand a buffer back
+        Drop    = 1,    // discard what doesn't fit and count it in Dropped()
+        Grow    = 2     // allocate another buffer, memory is unbounded
+    };
+
+    enum class WriteBehindFlush {
+        Async   = 0,    // Flush() hands the buffer over and returns
+        Wait    = 1     // Flush() behaves like Sync()
+    };
+
+    // decouples a producer from a slow target: writes land in memory and a
+    // dedicated thread drains full buffers into the target stream. like the
+    // ring streams it serves a single producer thread
+    class WriteBehindOStream final :
+        public SerialOStream {
+    public:
+        static constexpr size_t
+            uDefaultBufferSize  = 256 * 1024,
+            uDefaultBufferCount = 2;
+
+        WriteBehindOStream(
+            SerialOStream&      target,
+            size_t              uBufferSize     = uDefaultBufferSize,
+            size_t              uBufferCount    = uDefaultBufferCount,
+            WriteBehindPolicy   policy          = WriteBehindPolicy::Block,
+            WriteBehindFlush    flush           = WriteBehindFlush::Async) :
+            refTarget(target),
+            uBufferSize(std::max<size_t>(uBufferSize, 1)),
+            uBufferCount(std::max<size_t>(uBufferCount, 1)),
+            policy(policy),
+            flush(flush),
+            thread([this] { this->Drain(); }) {}
+
+        WriteBehindOStream(const WriteBehindOStream&) = delete;
+        WriteBehindOStream&
+        operator=(const WriteBehindOStream&) = delete;
+
+        ~WriteBehindOStream() noexcept {
+            this->Close();
+        }
+
+        [[nodiscard]] bool
+        EndOfStream() const noexcept override {
+            return false;
+        }
+
+        [[nodiscard]] bool
+        Good() const noexcept override {
+            return !this->bErr.load(std::memory_order_acquire);
+        }
+
+        void
+        ClearFlags() noexcept override {
+            this->bErr.store(false, std::memory_order_release);
+        }
+
+        bool
+        Flush() noexcept override {
+            if (this->flush == WriteBehindFlush::Wait)
+                return this->Sync();
+
+            this->Submit();
+            return this->Good();
+        }
+
+        // waits until everything written so far has reached the target,
+        // flushes it and, when it sits on a descriptor, syncs that to disk
+        bool
+        Sync() noexcept {
+            this->Submit();
+            {
+                std::unique_lock
+                    lock(this->mtx);
+                this->cvIdle.wait(lock, [this] {
+                    return this->dequePending.empty() && !this->bBusy;
+                });
+            }
+
+            if (!this->refTarget.Flush())
+                this->bErr.store(true, std::memory_order_release);
+
+            int
+                fd  = this->refTarget.SyncDescriptor();
+            if (fd >= 0 && fdatasync(fd) != 0)
+                this->bErr.store(true, std::memory_order_release);
+
+            return this->Good();
+        }
+
+        // drains what's left and stops the flusher; later writes fail
+        void
+        Close() noexcept {
+            if (!this->thread.joinable())
+                return;
+
+            this->Submit();
+            {
+                std::lock_guard
+                    lock(this->mtx);
+                this->bStop = true;
+            }
+            this->cvWork.notify_one();
+            this->thread.join();
+
+            if (!this->refTarget.Flush())
+                this->bErr.store(true, std::memory_order_release);
+        }
+
+        [[nodiscard]] uint64_t
+        Dropped() const noexcept {
+            return this->uDropped;
+        }
+
+        bool
+        Write(std::byte c) override {
+            return this->WriteSome({ &c, 1 }) == 1;
+        }
+
+        size_t
+        WriteSome(std::span<const std::byte> buffer) override {
+            size_t
+                uWritten    = 0;
+            while (uWritten != buffer.size()) {
+                if (!this->Reserve(1)) {
+                    if (this->policy != WriteBehindPolicy::Drop || !this->Good())
+                        return uWritten;
+
+                    this->uDropped  += buffer.size() - uWritten;
+                    return buffer.size();
+                }
+
+                size_t
+                    uCount  = std::min(buffer.size() - uWritten, this->uBufferSize - this->current.uSize);
+                memcpy(this->current.lpData.get() + this->current.uSize, buffer.data() + uWritten, uCount);
+                this->current.uSize += uCount;
+                uWritten            += uCount;
+            }
+
+            return uWritten;
+        }
+
+        std::span<std::byte>
+        BorrowWrite(size_t uMinSize) override {
+            if (uMinSize > this->uBufferSize || !this->Reserve(std::max<size_t>(uMinSize, 1)))
+                return {};
+
+            return {
+                this->current.lpData.get() + this->current.uSize,
+                this->uBufferSize - this->current.uSize };
+        }
+
+        void
+        Commit(size_t uCount) override {
+            this->current.uSize += uCount;
+        }
+
+    private:
+        struct Buffer {
+            std::unique_ptr<std::byte[]>
+                lpData;
+            size_t
+                uSize   = 0;
+        };
+
+        // makes sure the current buffer has uMinSize free bytes, handing a
+        // full one to the flusher; false when the policy won't provide room
+        bool
+        Reserve(size_t uMinSize) {
+            if (this->current.lpData && this->uBufferSize - this->current.uSize >= uMinSize)
+                return true;
+
+            if (!this->thread.joinable()) {
+                this->bErr.store(true, std::memory_order_release);
+                return false;
+            }
+
+            std::unique_lock
+                lock(this->mtx);
+            if (this->current.lpData) {
+                this->dequePending.push_back(std::move(this->current));
+                this->current   = {};
+                this->cvWork.notify_one();
+            }
+
+            if (this->dequeFree.empty() && !this->CanAllocate()) {
+                if (this->policy == WriteBehindPolicy::Drop)
+                    return false;
+
+                this->cvIdle.wait(lock, [this] {
+                    return !this->dequeFree.empty();
+                });
+            }
+
+            if (!this->dequeFree.empty()) {
+                this->current   = std::move(this->dequeFree.back());
+                this->dequeFree.pop_back();
+            } else {
+                this->current.lpData.reset(new std::byte[this->uBufferSize]);
+                this->uAllocated    += 1;
+            }
+
+            return true;
+        }
+
+        bool
+        CanAllocate() const noexcept {
+            return this->policy == WriteBehindPolicy::Grow || this->uAllocated < this->uBufferCount;
+        }
+
+        // a failed push_back leaves the buffer in place, so the data is
+        // kept for the next attempt and only the error is reported
+        void
+        Submit() noexcept {
+            if (this->current.uSize == 0)
+                return;
+
+            try {
+                std::lock_guard
+                    lock(this->mtx);
+                this->dequePending.push_back(std::move(this->current));
+                this->current   = {};
+            }
+            catch (const std::bad_alloc&) {
+                this->bErr.store(true, std::memory_order_release);
+                return;
+            }
+            this->cvWork.notify_one();
+        }
+
+        void
+        Drain() noexcept {
+            std::unique_lock
+                lock(this->mtx);
+            for (;;) {
+                this->cvWork.wait(lock, [this] {
+                    return !this->dequePending.empty() || this->bStop;
+                });
+                if (this->dequePending.empty())
+                    return;
+
+                Buffer
+                    buffer  = std::move(this->dequePending.front());
+                this->dequePending.pop_front();
+                this->bBusy = true;
+                lock.unlock();
+
+                bool
+                    bOk     = this->refTarget.WriteSome({ buffer.lpData.get(), buffer.uSize }) == buffer.uSize;
+
+                lock.lock();
+                // once the backlog is gone push the target's own buffer out too
+                if (this->dequePending.empty()) {
+                    lock.unlock();
+                    bOk     = this->refTarget.Flush() && bOk;
+                    lock.lock();
+                }
+
+                if (!bOk)
+                    this->bErr.store(true, std::memory_order_release);
+
+                buffer.uSize    = 0;
+                this->dequeFree.push_back(std::move(buffer));
+                this->bBusy = false;
+                this->cvIdle.notify_all();
+            }
+        }
+
+        SerialOStream&
+            refTarget;
+        size_t
+            uBufferSize     = 0,
+            uBufferCount    = 0,
+            uAllocated      = 0;
+        WriteBehindPolicy
+            policy;
+        WriteBehindFlush
+            flush;
+        Buffer
+            current;
+        uint64_t
+            uDropped        = 0;
+        std::atomic<bool>
+            bErr            = false;
+
+        std::mutex
+            mtx;
+        std::condition_variable
+            cvWork,
+            cvIdle;
+        std::deque<Buffer>
+            dequePending,
+            dequeFree;
+        bool
+            bStop           = false,
+            bBusy           = false;
+        std::thread
+            thread;
+    };
+}
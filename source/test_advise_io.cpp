@@ -0,0 +1,31 @@
+#include <ConsoleStreams.hpp>
+#include <FdStreams.hpp>
+#include <FileStreams.hpp>
+#include <IOReadWrite.hpp>
+
+int main() {
+    {
+        io::OFdStream
+            file("test_advise_io.txt");
+        for (int i = 0; i < 4096; ++i)
+            io::TextOutputOf(file).put("the answer is 42\n");
+    }
+
+    io::IFdStream
+        input("test_advise_io.txt");
+    input.Advise(io::AccessHint::Sequential);
+    input.SetDropBehind(16 * 1024);
+
+    std::string
+        strText;
+    io::TextInputOf(input)
+        .get_all(strText);
+    io::cout.fmt("read sequentially: {} bytes\n", strText.size());
+
+    io::IFileStream
+        file("test_advise_io.txt");
+    file.Advise(io::AccessHint::WillNeed);
+    io::TextInputOf(file)
+        .get_line(strText);
+    io::cout.fmt("first line: \"{}\"\n", strText);
+}
@@ -0,0 +1,29 @@
+#include <ConsoleStreams.hpp>
+#include <AsyncFileStreams.hpp>
+#include <IOReadWrite.hpp>
+
+int main() {
+    {
+        io::AsyncOFileStream
+            file("test_async_io.txt", 4, 4096);
+        io::TextOutputOf
+            out(file);
+        for (int i = 0; i < 100000; ++i)
+            out.put(i).put(' ');
+    }
+
+    io::AsyncIFileStream
+        file("test_async_io.txt", 4, 4096);
+    io::TextInputOf
+        in(file);
+
+    long
+        iSum    = 0;
+    for (int i = 0; i < 100000; ++i) {
+        int
+            iValue  = 0;
+        in.get(iValue);
+        iSum    += iValue;
+    }
+    io::cout.fmt("the sum: {}\n", iSum);
+}
@@ -0,0 +1,25 @@
+#include <ConsoleStreams.hpp>
+#include <BufferStreams.hpp>
+#include <IOReadWrite.hpp>
+
+int main() {
+    io::IOBufferStream
+        buffer;
+    io::TextOutputOf(buffer)
+        .put("the answer is 42");
+
+    // edits around one spot only move the gap a little
+    std::string_view
+        strvInsert  = "really ",
+        strvReplace = "not";
+    buffer.Insert(11, std::as_bytes(std::span(strvInsert)));
+    buffer.Replace(18, 20, std::as_bytes(std::span(strvReplace)));
+    buffer.Erase(0, 4);
+
+    std::string
+        strText;
+    io::TextInputOf(buffer)
+        .go_start()
+        .get_all(strText);
+    io::cout.fmt("edited: \"{}\"\n", strText);
+}
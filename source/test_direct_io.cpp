@@ -0,0 +1,48 @@
+#include <ConsoleStreams.hpp>
+#include <DirectStreams.hpp>
+#include <IOReadWrite.hpp>
+
+#include <string_view>
+#include <vector>
+
+int main() {
+    std::vector<std::byte>
+        vecBlocks(3 * 4096);
+    for (size_t i = 0; i != vecBlocks.size(); ++i)
+        vecBlocks[i] = (std::byte)(i * 13);
+
+    std::string_view
+        strvTail    = "an unaligned tail";
+    {
+        // the blocks overflow the buffer and go out aligned, the header
+        // is patched in place by reading its block back, and the tail
+        // is written at close without padding the file
+        io::DirectOFileStream
+            file("test_direct_io.bin", 8192);
+        io::BinaryOutput(file)
+            .put(uint32_t{ 0 })
+            .put(std::span<const std::byte>(vecBlocks))
+            .go_start()
+            .put(uint32_t{ 3 })
+            .go_end()
+            .put(std::span<const std::byte>((const std::byte*)strvTail.data(), strvTail.size()));
+        io::cout.fmt("direct: {}, alignment: {}\n", file.IsDirect(), file.Alignment());
+    }
+
+    io::DirectIFileStream
+        file("test_direct_io.bin", 8192);
+
+    uint32_t
+        uCount  = 0;
+    std::vector<std::byte>
+        vecRead(vecBlocks.size()),
+        vecTail(strvTail.size());
+    io::BinaryInput(file)
+        .get(uCount)
+        .get(std::span<std::byte>(vecRead))
+        .get(std::span<std::byte>(vecTail));
+    io::cout.fmt("blocks: {}, intact: {}, tail: '{}', size: {}\n",
+        uCount, vecRead == vecBlocks,
+        std::string_view((const char*)vecTail.data(), vecTail.size()),
+        file.GetPosition());
+}
@@ -0,0 +1,36 @@
+#include <ConsoleStreams.hpp>
+#include <FdStreams.hpp>
+#include <IOReadWrite.hpp>
+
+#include <vector>
+
+int main() {
+    std::vector<std::byte>
+        vecBlock(64 * 1024);
+    for (size_t i = 0; i != vecBlock.size(); ++i)
+        vecBlock[i] = (std::byte)(i * 7);
+
+    // the small fields are staged, the block is larger than the buffer
+    // and goes to write() directly once the staged bytes are out
+    io::IOFdStream
+        file("test_fd_io.bin", O_RDWR | O_CREAT | O_TRUNC, 4096);
+    io::BinaryOutput(file)
+        .put(uint32_t{ 42 })
+        .put(std::span<const std::byte>(vecBlock))
+        .put(uint32_t{ 7 });
+    io::cout.fmt("written: {} bytes through a {} byte buffer\n",
+        file.GetPosition(), file.BufferSize());
+
+    uint32_t
+        uHead   = 0,
+        uTail   = 0;
+    std::vector<std::byte>
+        vecRead(vecBlock.size());
+    io::BinaryInput(file)
+        .go_start()
+        .get(uHead)
+        .get(std::span<std::byte>(vecRead))
+        .get(uTail);
+    io::cout.fmt("read back: {} and {}, block intact: {}\n",
+        uHead, uTail, vecRead == vecBlock);
+}
@@ -0,0 +1,36 @@
+#include <ConsoleStreams.hpp>
+#include <FileStreams.hpp>
+#include <IOReadWrite.hpp>
+
+int main() {
+    io::std_output.SetBuffering({ io::BufferMode::Line });
+
+    {
+        io::OFileStream
+            file("test_file_buffering_io.txt", io::FileBuffer{ io::BufferMode::Full, 1024 * 1024 });
+        for (int i = 0; i != 10000; ++i) {
+            io::TextOutputOf(file)
+                .put("row ")
+                .put(i)
+                .put_endl();
+        }
+        io::cout.fmt("exported: {} bytes\n", file.GetPosition());
+    }
+
+    char
+        buffer[4096];
+    io::IFileStream
+        file("test_file_buffering_io.txt", io::FileBuffer{ io::BufferMode::Full, sizeof(buffer), buffer });
+    std::string
+        strLine;
+    size_t
+        uLines  = 0;
+    for (;;) {
+        io::TextInputOf(file)
+            .get_line(strLine);
+        if (strLine.empty() && file.EndOfStream())
+            break;
+        uLines  += 1;
+    }
+    io::cout.fmt("imported: {} lines\n", uLines);
+}
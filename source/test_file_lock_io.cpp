@@ -0,0 +1,36 @@
+#include <ConsoleStreams.hpp>
+#include <FileStreams.hpp>
+#include <IOReadWrite.hpp>
+
+#include <thread>
+
+int main() {
+    io::OFileStream
+        file("test_file_lock_io.txt");
+
+    // the worker doesn't own the sessions below, so it keeps the locking
+    // calls and its writes wait until the current session ends
+    std::thread
+        worker([&file]() {
+            for (int i = 0; i != 1000; ++i) {
+                io::TextOutputOf(file)
+                    .put("worker #")
+                    .put(i)
+                    .put_endl();
+            }
+        });
+
+    for (int i = 0; i != 10; ++i) {
+        io::FileLockSession
+            session(file);
+        for (int j = 0; j != 100; ++j) {
+            io::TextOutputOf(file)
+                .put("session #")
+                .put(i)
+                .put_endl();
+        }
+    }
+
+    worker.join();
+    io::cout.fmt("written: {} bytes\n", file.GetPosition());
+}
@@ -0,0 +1,44 @@
+#include <ConsoleStreams.hpp>
+#include <MappedStreams.hpp>
+#include <IOReadWrite.hpp>
+
+#include <filesystem>
+
+int main() {
+    constexpr uint64_t
+        uRecords    = 300000;
+
+    {
+        // a count header, then records well past the first growth step
+        io::MappedOFileStream
+            file("test_mapped_io.bin");
+        io::BinaryOutput(file)
+            .put(uint64_t{ 0 });
+        for (uint64_t i = 0; i != uRecords; ++i) {
+            io::BinaryOutput(file)
+                .put(i * 3);
+        }
+        io::cout.fmt("before flush: {} bytes written, {} on disk\n",
+            file.GetPosition(), std::filesystem::file_size("test_mapped_io.bin"));
+
+        // the patch is a plain store into the mapping
+        io::BinaryOutput(file)
+            .go_start()
+            .put(uRecords);
+        file.Flush();
+        io::cout.fmt("after flush: {} on disk\n",
+            std::filesystem::file_size("test_mapped_io.bin"));
+    }
+
+    io::MappedIFileStream
+        mapped("test_mapped_io.bin", io::AccessHint::Sequential);
+    uint64_t
+        uCount  = 0,
+        uLast   = 0;
+    io::BinaryInput(mapped)
+        .get(uCount)
+        .go(-(intptr_t)sizeof(uint64_t), io::StreamOffsetOrigin::StreamEnd)
+        .get(uLast);
+    io::cout.fmt("mapped {} bytes: {} records, the last one {}\n",
+        mapped.Buffer().size(), uCount, uLast);
+}
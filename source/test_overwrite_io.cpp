@@ -0,0 +1,27 @@
+#include <ConsoleStreams.hpp>
+#include <BufferStreams.hpp>
+#include <IOReadWrite.hpp>
+
+int main() {
+    io::IOBufferStream
+        buffer(io::BufferWriteMode::Overwrite);
+    io::TextOutputOf(buffer)
+        .put("the answer is 42")
+        .go_start()
+        .put("THE")
+        .go(-2, io::StreamOffsetOrigin::StreamEnd)
+        .put("4200");
+
+    std::string_view
+        strvPatch   = "ANSWER";
+    if (buffer.Overwrite(100, std::as_bytes(std::span(strvPatch))) < 0)
+        io::cout.put("rejected an overwrite past the end\n");
+    buffer.Overwrite(4, std::as_bytes(std::span(strvPatch)));
+
+    std::string
+        strText;
+    io::TextInputOf(buffer)
+        .go_start()
+        .get_all(strText);
+    io::cout.fmt("overwritten: \"{}\"\n", strText);
+}
@@ -0,0 +1,25 @@
+#include <ConsoleStreams.hpp>
+#include <BufferStreams.hpp>
+#include <IOReadWrite.hpp>
+
+int main() {
+    std::string_view
+        strvOriginal    = "one two three four";
+    io::IOPieceTableStream
+        table(std::as_bytes(std::span(strvOriginal)));
+
+    // edits only split pieces, the original bytes are never moved
+    std::string_view
+        strvInsert  = "and a half ",
+        strvReplace = "3";
+    table.Insert(8, std::as_bytes(std::span(strvInsert)));
+    table.Erase(0, 4);
+    table.Replace(15, 20, std::as_bytes(std::span(strvReplace)));
+
+    std::string
+        strText;
+    io::TextInputOf(table)
+        .go_start()
+        .get_all(strText);
+    io::cout.fmt("edited: \"{}\"\n", strText);
+}
@@ -0,0 +1,31 @@
+#include <ConsoleStreams.hpp>
+#include <FdStreams.hpp>
+#include <RegionStreams.hpp>
+#include <IOReadWrite.hpp>
+
+int main() {
+    const uint64_t
+        lpSizes[]   = { 12, 12, 12, 12 };
+
+    bool
+        bOk = io::ParallelFileWriter("test_region_io.txt")
+            .Run(lpSizes, [](size_t uIndex, io::RegionOStream& region) {
+                io::TextOutputOf(region)
+                    .put("region ")
+                    .put((int)uIndex)
+                    .put("...\n");
+            });
+
+    io::IFdStream
+        file("test_region_io.txt");
+
+    std::string
+        strWord;
+    int
+        iValue  = 0;
+    io::TextInputOf(file)
+        .go(36)
+        .get(strWord)
+        .get(iValue);
+    io::cout.fmt("written: {}, the last region: {}\n", bOk, iValue);
+}
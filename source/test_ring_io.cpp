@@ -0,0 +1,35 @@
+#include <ConsoleStreams.hpp>
+#include <RingStreams.hpp>
+#include <IOReadWrite.hpp>
+
+#include <thread>
+
+int main() {
+    io::RingBuffer
+        ring(64);
+
+    std::thread
+        producer([&ring]() {
+            io::ORingBufferStream
+                ostream(ring);
+            for (int i = 0; i != 16; ++i) {
+                io::SerialTextOutput(ostream)
+                    .put("message #")
+                    .put(i)
+                    .put_endl();
+            }
+        });
+
+    io::IRingBufferStream
+        istream(ring);
+    while (!istream.EndOfStream()) {
+        std::string
+            strMessage;
+        io::SerialTextInput(istream)
+            .get_line(strMessage);
+        if (!strMessage.empty())
+            io::cout.fmt("received: \"{}\"\n", strMessage);
+    }
+
+    producer.join();
+}
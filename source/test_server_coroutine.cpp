@@ -0,0 +1,57 @@
+#include <ConsoleStreams.hpp>
+#include <CoroutineStreams.hpp>
+
+io::Task<>
+Serve(io::NetworkScheduler& scheduler, io::AsyncNetworkStream stream, io::IPv4::Addr addr) {
+    io::cout.fmt("accepted a connection from {}\n",
+        addr.ToString());
+
+    io::AsyncTextInput
+        input(stream);
+    std::string
+        strMessage;
+    while (co_await input.get_line(strMessage)) {
+        io::cout.fmt("accepted message: \"{}\"\n", strMessage);
+        if (strMessage == "/exit")
+            scheduler.Stop();
+    }
+
+    io::cout.fmt("{} disconnected\n",
+        addr.ToString());
+}
+
+io::Task<>
+Listen(io::NetworkScheduler& scheduler, io::AsyncNetworkServer<io::IPv4::Addr>& server) {
+    for (;;) {
+        auto
+            optConnection   = co_await server.AsyncAccept();
+        // running out of descriptors only delays the accept, so this is
+        // a failure of the listening socket itself
+        if (!optConnection) {
+            io::cerr.put("failed to accept a connection\n");
+            scheduler.Stop();
+            co_return;
+        }
+
+        scheduler.Spawn(Serve(scheduler,
+            std::move(optConnection->first),
+            optConnection->second));
+    }
+}
+
+int main() {
+    try {
+        io::NetworkScheduler
+            scheduler;
+        io::AsyncNetworkServer<io::IPv4::Addr>
+            server(scheduler, io::IPv4::Addr{1337});
+
+        scheduler.Spawn(Listen(scheduler, server));
+        io::cout.put("accepting connections\n");
+        scheduler.Run();
+    }
+    catch (std::exception& err) {
+        io::cerr.fmt("error: {}\n", err.what());
+        return EXIT_FAILURE;
+    }
+}
@@ -0,0 +1,44 @@
+#include <ConsoleStreams.hpp>
+#include <ReactorStreams.hpp>
+
+int main() {
+    try {
+        io::NetworkReactor<io::IPv4::Addr>
+            reactor(io::IPv4::Addr{1337});
+
+        reactor.OnAccept([](auto& connection) {
+            io::cout.fmt("accepted a connection from {}\n",
+                connection.addr.ToString());
+        });
+
+        reactor.OnData([&reactor](auto& connection) {
+            for (;;) {
+                std::span<const std::byte>
+                    window  = connection.stream.BorrowRead();
+                auto
+                    itEnd   = std::find(window.begin(), window.end(), (std::byte)'\n');
+                if (itEnd == window.end())
+                    return;
+
+                std::string_view
+                    strvMessage((const char*)window.data(), (size_t)(itEnd - window.begin()));
+                io::cout.fmt("accepted message: \"{}\"\n", strvMessage);
+                if (strvMessage == "/exit")
+                    reactor.Stop();
+                connection.stream.Consume(strvMessage.size() + 1);
+            }
+        });
+
+        reactor.OnClose([](auto& connection) {
+            io::cout.fmt("{} disconnected\n",
+                connection.addr.ToString());
+        });
+
+        io::cout.put("accepting connections\n");
+        reactor.Run();
+    }
+    catch (std::exception& err) {
+        io::cerr.fmt("error: {}\n", err.what());
+        return EXIT_FAILURE;
+    }
+}
@@ -0,0 +1,53 @@
+#include <ConsoleStreams.hpp>
+#include <SpanStreams.hpp>
+#include <IOReadWrite.hpp>
+
+int main() {
+    // a packet on the stack: a value count, then as many values as fit
+    std::byte
+        lpPacket[30];
+    io::OSpanStream
+        packet(lpPacket);
+
+    uint32_t
+        uCount  = 0;
+    bool
+        bGood   = true;
+    io::BinaryOutput(packet)
+        .put(uCount);
+    for (uint32_t i = 0; bGood; ++i) {
+        io::BinaryOutput(packet)
+            .put(i * i)
+            .good(bGood);
+        if (bGood)
+            uCount  += 1;
+    }
+    io::cout.fmt("the packet is full after {} values\n", uCount);
+
+    // the header is patched in place, the seek is only an offset
+    packet.ClearFlags();
+    io::BinaryOutput(packet)
+        .go_start()
+        .put(uCount);
+
+    io::ISpanStream
+        input(packet.Buffer().first(sizeof(uint32_t) * (uCount + 1)));
+    uint32_t
+        uStored = 0,
+        uSum    = 0;
+    io::BinaryInput(input)
+        .get(uStored);
+    for (;;) {
+        uint32_t
+            uValue  = 0;
+        bool
+            bEnded  = false;
+        io::BinaryInput(input)
+            .get(uValue)
+            .ended(bEnded);
+        if (bEnded)
+            break;
+        uSum    += uValue;
+    }
+    io::cout.fmt("read back {} values, their sum: {}\n", uStored, uSum);
+}
@@ -0,0 +1,25 @@
+#include <ConsoleStreams.hpp>
+#include <FileStreams.hpp>
+#include <WriteBehindStreams.hpp>
+#include <IOReadWrite.hpp>
+
+int main() {
+    io::std_output.SetBuffering({ io::BufferMode::Full, 64 * 1024 });
+
+    io::OFileStream
+        file("test_write_behind_io.txt", io::FileBuffer{ io::BufferMode::Full, 1024 * 1024 });
+    {
+        io::WriteBehindOStream
+            log(file, 4096, 4);
+        for (int i = 0; i != 10000; ++i) {
+            io::SerialTextOutput(log)
+                .put("record #")
+                .put(i)
+                .put_endl();
+        }
+        log.Sync();
+        io::cout.fmt("synced, dropped: {}\n", log.Dropped());
+    }
+
+    io::cout.fmt("file size: {}\n", file.GetPosition());
+}